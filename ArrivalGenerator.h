@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <string>
+#include <algorithm>
+
+enum class ArrivalDistribution {
+    CONSTANT, // One process every batch-process-freq ticks
+    POISSON,  // Exponential gaps with the same mean
+    BURSTY    // arrival-burst-size processes at once, every burst-size * batch-process-freq ticks
+};
+
+// Counts the processes owed between tick checks, so generation keeps up with the CPU tick
+// counter however often it polls. Arrival times are kept as doubles to carry fractions over.
+class ArrivalGenerator {
+public:
+    static ArrivalDistribution distributionFromString(const std::string& name) {
+        if (name == "poisson") return ArrivalDistribution::POISSON;
+        if (name == "bursty") return ArrivalDistribution::BURSTY;
+        return ArrivalDistribution::CONSTANT;
+    }
+
+    void reset(uint64_t startTick, ArrivalDistribution newDistribution, uint32_t ticksPerArrival,
+               uint32_t newBurstSize, uint32_t seed) {
+        distribution = newDistribution;
+        meanGap = std::max(uint32_t(1), ticksPerArrival);
+        burstSize = std::max(uint32_t(1), newBurstSize);
+        rng.seed(seed);
+        nextArrival = static_cast<double>(startTick) + firstGap();
+    }
+
+    // Arrivals due at or before tick; advances past them
+    uint64_t arrivalsUntil(uint64_t tick) {
+        uint64_t due = 0;
+        while (nextArrival <= static_cast<double>(tick)) {
+            if (distribution == ArrivalDistribution::BURSTY) {
+                due += burstSize;
+                nextArrival += meanGap * burstSize;
+            } else {
+                ++due;
+                nextArrival += distribution == ArrivalDistribution::POISSON ? exponentialGap() : meanGap;
+            }
+        }
+        return due;
+    }
+
+private:
+    ArrivalDistribution distribution = ArrivalDistribution::CONSTANT;
+    double meanGap = 1.0;
+    uint32_t burstSize = 1;
+    double nextArrival = 0.0;
+    std::mt19937 rng{std::random_device{}()};
+
+    double exponentialGap() {
+        return std::exponential_distribution<double>(1.0 / meanGap)(rng);
+    }
+
+    double firstGap() {
+        switch (distribution) {
+            case ArrivalDistribution::POISSON: return exponentialGap();
+            case ArrivalDistribution::BURSTY: return meanGap * burstSize;
+            default: return meanGap;
+        }
+    }
+};
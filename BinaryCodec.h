@@ -0,0 +1,147 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+
+// 64-bit FNV-1a, used to check checkpoint bodies and to key cached programs by content
+inline uint64_t fnv1a(const char* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Byte encoding shared by workload files and checkpoints. Integers are LEB128 varints.
+// putString interns: a varint index into the strings seen so far, followed by the length and
+// bytes only the first time, so repeated names and messages cost a byte or two. putBytes is for
+// text that rarely repeats, such as log lines, and is always written out in full.
+class BinaryWriter {
+public:
+    void putByte(uint8_t value) { buffer.push_back(static_cast<char>(value)); }
+
+    void putVarint(uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    void putFixed32(uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) putByte(static_cast<uint8_t>(value >> shift));
+    }
+
+    void putFixed64(uint64_t value) {
+        for (int shift = 0; shift < 64; shift += 8) putByte(static_cast<uint8_t>(value >> shift));
+    }
+
+    void putBytes(std::string_view text) {
+        putVarint(text.size());
+        buffer.insert(buffer.end(), text.begin(), text.end());
+    }
+
+    void putString(const std::string& text) {
+        auto [it, added] = strings.try_emplace(text, static_cast<uint32_t>(strings.size()));
+        putVarint(it->second);
+        if (added) putBytes(text);
+    }
+
+    const std::vector<char>& data() const { return buffer; }
+    size_t size() const { return buffer.size(); }
+    // Drops the encoded bytes but keeps the string table, for streams written a record at a time
+    void clearBuffer() { buffer.clear(); }
+    void reset() {
+        buffer.clear();
+        strings.clear();
+    }
+
+private:
+    std::vector<char> buffer;
+    std::unordered_map<std::string, uint32_t> strings;
+};
+
+// Reads what BinaryWriter wrote; every getter returns false on exhausted or malformed input
+class BinaryReader {
+public:
+    BinaryReader() = default;
+    BinaryReader(const char* begin, const char* end) : pos(begin), end(end) {}
+
+    bool getByte(uint8_t& value) {
+        if (pos >= end) return false;
+        value = static_cast<uint8_t>(*pos++);
+        return true;
+    }
+
+    bool getVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+            uint8_t byte = static_cast<uint8_t>(*pos++);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        pos = end;
+        return false;
+    }
+
+    template <typename T>
+    bool getVarint(T& value) {
+        uint64_t wide;
+        if (!getVarint(wide)) return false;
+        value = static_cast<T>(wide);
+        return true;
+    }
+
+    bool getFixed32(uint32_t& value) {
+        if (end - pos < 4) return false;
+        value = 0;
+        for (int shift = 0; shift < 32; shift += 8) value |= static_cast<uint32_t>(static_cast<uint8_t>(*pos++)) << shift;
+        return true;
+    }
+
+    bool getFixed64(uint64_t& value) {
+        if (end - pos < 8) return false;
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 8) value |= static_cast<uint64_t>(static_cast<uint8_t>(*pos++)) << shift;
+        return true;
+    }
+
+    bool getRaw(void* data, size_t size) {
+        if (static_cast<size_t>(end - pos) < size) return false;
+        std::memcpy(data, pos, size);
+        pos += size;
+        return true;
+    }
+
+    bool getBytes(std::string& text) {
+        uint64_t length;
+        if (!getVarint(length) || static_cast<uint64_t>(end - pos) < length) return false;
+        text.assign(pos, static_cast<size_t>(length));
+        pos += length;
+        return true;
+    }
+
+    bool getString(std::string& text) {
+        uint64_t index;
+        if (!getVarint(index)) return false;
+        if (index < strings.size()) {
+            text = strings[index];
+            return true;
+        }
+        if (index != strings.size() || !getBytes(text)) return false;
+        strings.push_back(text);
+        return true;
+    }
+
+    bool atEnd() const { return pos >= end; }
+    size_t remaining() const { return static_cast<size_t>(end - pos); }
+
+private:
+    const char* pos = nullptr;
+    const char* end = nullptr;
+    std::vector<std::string> strings;
+};
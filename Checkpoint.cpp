@@ -0,0 +1,90 @@
+#include "Checkpoint.h"
+#include "BinaryCodec.h"
+#include <fstream>
+#include <filesystem>
+#include <system_error>
+#include <cstring>
+
+namespace {
+    constexpr char CHECKPOINT_MAGIC[4] = {'C', 'S', 'C', 'K'};
+    constexpr size_t HEADER_SIZE = 4 + 4 + 8 + 8;
+}
+
+bool writeCheckpointFile(const std::string& path, const std::vector<char>& body, std::string& error) {
+    BinaryWriter header;
+    for (char c : CHECKPOINT_MAGIC) header.putByte(static_cast<uint8_t>(c));
+    header.putFixed32(CHECKPOINT_VERSION);
+    header.putFixed64(body.size());
+    header.putFixed64(fnv1a(body.data(), body.size()));
+
+    // Written beside the target and renamed over it, so a crash mid-write leaves the previous
+    // checkpoint intact
+    std::string tempPath = path + ".tmp";
+    std::error_code ignored;
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        error = "could not open " + tempPath;
+        return false;
+    }
+    file.write(header.data().data(), static_cast<std::streamsize>(header.size()));
+    file.write(body.data(), static_cast<std::streamsize>(body.size()));
+    file.flush();
+    file.close();
+    if (!file) {
+        std::filesystem::remove(tempPath, ignored);
+        error = "write to " + tempPath + " failed";
+        return false;
+    }
+    std::error_code renameError;
+    std::filesystem::rename(tempPath, path, renameError);
+    if (renameError) {
+        std::filesystem::remove(tempPath, ignored);
+        error = "could not replace " + path + ": " + renameError.message();
+        return false;
+    }
+    return true;
+}
+
+bool readCheckpointFile(const std::string& path, std::vector<char>& body, std::string& error) {
+    body.clear();
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        error = "could not open " + path;
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    if (size < static_cast<std::streamsize>(HEADER_SIZE)) {
+        error = "not a checkpoint";
+        return false;
+    }
+    std::vector<char> contents(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(contents.data(), size)) {
+        error = "read failed";
+        return false;
+    }
+
+    BinaryReader header(contents.data(), contents.data() + HEADER_SIZE);
+    char magic[4];
+    uint32_t version;
+    uint64_t length, hash;
+    header.getRaw(magic, 4);
+    header.getFixed32(version);
+    header.getFixed64(length);
+    header.getFixed64(hash);
+    if (std::memcmp(magic, CHECKPOINT_MAGIC, 4) != 0) {
+        error = "not a checkpoint";
+        return false;
+    }
+    if (version != CHECKPOINT_VERSION) {
+        error = "checkpoint version " + std::to_string(version) + ", expected " + std::to_string(CHECKPOINT_VERSION);
+        return false;
+    }
+    if (length != contents.size() - HEADER_SIZE || fnv1a(contents.data() + HEADER_SIZE, length) != hash) {
+        error = "checkpoint is truncated or corrupt";
+        return false;
+    }
+    contents.erase(contents.begin(), contents.begin() + HEADER_SIZE);
+    body.swap(contents);
+    return true;
+}
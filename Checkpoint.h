@@ -0,0 +1,18 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+Checkpoint file layout:
+  header {magic "CSCK", u32 version, u64 body length, u64 FNV-1a hash of the body}, little endian
+  body   one BinaryWriter stream: config.txt text, console state, process table, allocator, scheduler
+The hash is checked before anything is restored, so a truncated or damaged file is rejected while
+the running simulation is still intact.
+*/
+constexpr uint32_t CHECKPOINT_VERSION = 3;
+
+// Header and body go out through one buffered stream to path.tmp, which then replaces path
+bool writeCheckpointFile(const std::string& path, const std::vector<char>& body, std::string& error);
+// Reads the whole file with one read and verifies it; body is left empty on failure
+bool readCheckpointFile(const std::string& path, std::vector<char>& body, std::string& error);
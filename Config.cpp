@@ -1,7 +1,9 @@
 #include "Config.h"
 #include <fstream>
+#include <ostream>
 #include <iostream>
 #include <cstdint>
+#include <algorithm>
 
 bool readConfigFromFile(const std::string& filename, SystemConfig& config) {
     std::ifstream file(filename);
@@ -9,11 +11,18 @@ bool readConfigFromFile(const std::string& filename, SystemConfig& config) {
         std::cerr << "Error: Could not open config.txt\n";
         return false;
     }
+    return readConfig(file, config);
+}
 
+bool readConfig(std::istream& file, SystemConfig& config) {
     std::string key;
     while (file >> key) {
         if (key == "num-cpu") {
             file >> config.numCPU;
+            if (config.numCPU < 1 || config.numCPU > 256) {
+                std::cerr << "Error: num-cpu must be between 1 and 256\n";
+                return false;
+            }
         }
         else if (key == "scheduler") {
             std::string schedulerValue;
@@ -33,6 +42,23 @@ bool readConfigFromFile(const std::string& filename, SystemConfig& config) {
             file >> val;
             config.batchProcessFreq = val;
         }
+        else if (key == "arrival-distribution") {
+            std::string distributionValue;
+            file >> distributionValue;
+            if (distributionValue.front() == '"' && distributionValue.back() == '"') {
+                distributionValue = distributionValue.substr(1, distributionValue.length() - 2);
+            }
+            if (distributionValue != "constant" && distributionValue != "poisson" && distributionValue != "bursty") {
+                std::cerr << "Error: arrival-distribution must be constant, poisson or bursty\n";
+                return false;
+            }
+            config.arrivalDistribution = distributionValue;
+        }
+        else if (key == "arrival-burst-size") {
+            uint32_t val;
+            file >> val;
+            config.arrivalBurstSize = std::max(uint32_t(1), val);
+        }
         else if (key == "min-ins") {
             uint32_t val;
             file >> val;
@@ -67,7 +93,7 @@ bool readConfigFromFile(const std::string& filename, SystemConfig& config) {
             }
             config.memPerFrame = val;
         }
-        //NOTE: For MO2, this should be changed to min-mem-per-proc and max-mem-per-proc
+        // Legacy single size; sets both ends of the min/max range
         else if (key == "mem-per-proc") {
             uint32_t val;
             file >> val;
@@ -76,6 +102,186 @@ bool readConfigFromFile(const std::string& filename, SystemConfig& config) {
                 return false;
             }
             config.memPerProc = val;
+            config.minMemPerProc = val;
+            config.maxMemPerProc = val;
+        }
+        else if (key == "min-mem-per-proc" || key == "max-mem-per-proc") {
+            uint32_t val;
+            file >> val;
+            if (val < 64 || val > 65536 || (val & (val - 1)) != 0) {
+                std::cerr << "Error: " << key << " must be a power of 2 in [2^6, 2^16] (64 to 65536)\n";
+                return false;
+            }
+            if (key == "min-mem-per-proc") {
+                config.minMemPerProc = val;
+            } else {
+                config.maxMemPerProc = val;
+            }
+        }
+        else if (key == "mem-alloc-policy") {
+            std::string policyValue;
+            file >> policyValue;
+            if (policyValue.front() == '"' && policyValue.back() == '"') {
+                policyValue = policyValue.substr(1, policyValue.length() - 2);
+            }
+            if (policyValue != "first-fit" && policyValue != "best-fit" &&
+                policyValue != "next-fit" && policyValue != "worst-fit") {
+                std::cerr << "Error: mem-alloc-policy must be one of first-fit, best-fit, next-fit, worst-fit\n";
+                return false;
+            }
+            config.memAllocPolicy = policyValue;
+        }
+        else if (key == "compaction-threshold") {
+            uint32_t val;
+            file >> val;
+            if (val > 100) {
+                std::cerr << "Error: compaction-threshold must be a percentage in [0, 100]\n";
+                return false;
+            }
+            config.compactionThreshold = val;
+        }
+        else if (key == "compaction-blocks-per-pass") {
+            uint32_t val;
+            file >> val;
+            config.compactionBlocksPerPass = std::max(uint32_t(1), val);
+        }
+        else if (key == "memory-wait-order") {
+            std::string orderValue;
+            file >> orderValue;
+            if (orderValue.front() == '"' && orderValue.back() == '"') {
+                orderValue = orderValue.substr(1, orderValue.length() - 2);
+            }
+            if (orderValue != "arrival" && orderValue != "size") {
+                std::cerr << "Error: memory-wait-order must be either arrival or size\n";
+                return false;
+            }
+            config.memoryWaitOrder = orderValue;
+        }
+        else if (key == "tlb-entries") {
+            uint32_t val;
+            file >> val;
+            if (val < 1 || val > 4096) {
+                std::cerr << "Error: tlb-entries must be in [1, 4096]\n";
+                return false;
+            }
+            config.tlbEntries = val;
+        }
+        else if (key == "tlb-ways") {
+            uint32_t val;
+            file >> val;
+            config.tlbWays = std::max(uint32_t(1), val);
+        }
+        else if (key == "tlb-asid") {
+            uint32_t val;
+            file >> val;
+            config.tlbAsid = val != 0;
+        }
+        else if (key == "tlb-walk-cycles") {
+            uint32_t val;
+            file >> val;
+            config.tlbWalkCycles = val;
+        }
+        else if (key == "snapshot-queue-depth") {
+            uint32_t val;
+            file >> val;
+            config.snapshotQueueDepth = std::max(uint32_t(1), val);
+        }
+        else if (key == "snapshot-overflow") {
+            std::string overflowValue;
+            file >> overflowValue;
+            if (overflowValue.front() == '"' && overflowValue.back() == '"') {
+                overflowValue = overflowValue.substr(1, overflowValue.length() - 2);
+            }
+            if (overflowValue != "drop" && overflowValue != "coalesce") {
+                std::cerr << "Error: snapshot-overflow must be either drop or coalesce\n";
+                return false;
+            }
+            config.snapshotOverflow = overflowValue;
+        }
+        else if (key == "snapshot-format") {
+            std::string formatValue;
+            file >> formatValue;
+            if (formatValue.front() == '"' && formatValue.back() == '"') {
+                formatValue = formatValue.substr(1, formatValue.length() - 2);
+            }
+            if (formatValue != "binary" && formatValue != "text") {
+                std::cerr << "Error: snapshot-format must be either binary or text\n";
+                return false;
+            }
+            config.snapshotFormat = formatValue;
+        }
+        else if (key == "snapshot-keyframe-interval") {
+            uint32_t val;
+            file >> val;
+            config.snapshotKeyframeInterval = std::max(uint32_t(1), val);
+        }
+        else if (key == "retire-logs") {
+            std::string retireValue;
+            file >> retireValue;
+            if (retireValue.front() == '"' && retireValue.back() == '"') {
+                retireValue = retireValue.substr(1, retireValue.length() - 2);
+            }
+            if (retireValue != "keep" && retireValue != "spill" && retireValue != "drop") {
+                std::cerr << "Error: retire-logs must be keep, spill or drop\n";
+                return false;
+            }
+            config.retireLogs = retireValue;
+        }
+        else if (key == "log-flush-ms") {
+            uint32_t val;
+            file >> val;
+            config.logFlushMillis = std::max(uint32_t(1), val);
+        }
+        else if (key == "log-flush-bytes") {
+            uint32_t val;
+            file >> val;
+            config.logFlushBytes = std::max(uint32_t(1), val);
+        }
+        else if (key == "log-tail-lines") {
+            uint32_t val;
+            file >> val;
+            config.logTailLines = std::max(uint32_t(1), val);
+        }
+        else if (key == "trace-events") {
+            uint32_t val;
+            file >> val;
+            config.traceEvents = val != 0;
+        }
+        else if (key == "trace-buffer-events") {
+            uint32_t val;
+            file >> val;
+            config.traceBufferEvents = std::max(uint32_t(2), val);
+        }
+        else if (key == "utilization-sample-ticks") {
+            uint32_t val;
+            file >> val;
+            config.utilizationSampleTicks = val;
+        }
+        else if (key == "utilization-csv") {
+            std::string csvValue;
+            file >> csvValue;
+            if (csvValue.front() == '"' && csvValue.back() == '"') {
+                csvValue = csvValue.substr(1, csvValue.length() - 2);
+            }
+            config.utilizationCsv = csvValue;
+        }
+        else if (key == "tick-ms") {
+            uint32_t val;
+            file >> val;
+            config.tickMillis = val;
+        }
+        else if (key == "random-seed") {
+            uint32_t val;
+            file >> val;
+            config.randomSeed = val;
+        }
+        else if (key == "workload-record" || key == "workload-replay") {
+            std::string path;
+            file >> path;
+            if (path.size() >= 2 && path.front() == '"' && path.back() == '"') {
+                path = path.substr(1, path.length() - 2);
+            }
+            (key == "workload-record" ? config.workloadRecord : config.workloadReplay) = path;
         }
         else {
             std::cerr << "Warning: Unknown config parameter: " << key << "\n";
@@ -84,6 +290,67 @@ bool readConfigFromFile(const std::string& filename, SystemConfig& config) {
         }
     }
 
-    file.close();
+    if (config.minMemPerProc == 0) config.minMemPerProc = config.maxMemPerProc;
+    if (config.maxMemPerProc == 0) config.maxMemPerProc = config.minMemPerProc;
+    if (config.maxMemPerProc == 0) {
+        std::cerr << "Error: set mem-per-proc or min-mem-per-proc/max-mem-per-proc\n";
+        return false;
+    }
+    if (config.minMemPerProc > config.maxMemPerProc) {
+        std::cerr << "Error: min-mem-per-proc must not exceed max-mem-per-proc\n";
+        return false;
+    }
+    if (config.maxOverallMem && config.maxMemPerProc > config.maxOverallMem) {
+        // A process that size could never be admitted, so it would wait for memory forever
+        std::cerr << "Error: max-mem-per-proc must not exceed max-overall-mem\n";
+        return false;
+    }
+    config.memPerProc = config.minMemPerProc;
+    if (config.tlbWays > config.tlbEntries || config.tlbEntries % config.tlbWays != 0) {
+        std::cerr << "Error: tlb-ways must divide tlb-entries\n";
+        return false;
+    }
     return true;
-}
\ No newline at end of file
+}
+
+void writeConfig(std::ostream& out, const SystemConfig& config) {
+    auto quoted = [](const std::string& value) { return "\"" + value + "\""; };
+    out << "num-cpu " << config.numCPU << "\n"
+        << "scheduler " << quoted(config.scheduler) << "\n"
+        << "quantum-cycles " << config.quantumCycles << "\n"
+        << "batch-process-freq " << config.batchProcessFreq << "\n"
+        << "arrival-distribution " << quoted(config.arrivalDistribution) << "\n"
+        << "arrival-burst-size " << config.arrivalBurstSize << "\n"
+        << "min-ins " << config.minInstructions << "\n"
+        << "max-ins " << config.maxInstructions << "\n"
+        << "delay-per-exec " << config.delaysPerExec << "\n";
+    // Memory sizes are validated as powers of two, so unset (zero) ones are left out
+    if (config.maxOverallMem) out << "max-overall-mem " << config.maxOverallMem << "\n";
+    if (config.memPerFrame) out << "mem-per-frame " << config.memPerFrame << "\n";
+    if (config.minMemPerProc) out << "min-mem-per-proc " << config.minMemPerProc << "\n";
+    if (config.maxMemPerProc) out << "max-mem-per-proc " << config.maxMemPerProc << "\n";
+    out << "mem-alloc-policy " << quoted(config.memAllocPolicy) << "\n"
+        << "compaction-threshold " << config.compactionThreshold << "\n"
+        << "compaction-blocks-per-pass " << config.compactionBlocksPerPass << "\n"
+        << "memory-wait-order " << quoted(config.memoryWaitOrder) << "\n"
+        << "tlb-entries " << config.tlbEntries << "\n"
+        << "tlb-ways " << config.tlbWays << "\n"
+        << "tlb-asid " << (config.tlbAsid ? 1 : 0) << "\n"
+        << "tlb-walk-cycles " << config.tlbWalkCycles << "\n"
+        << "snapshot-queue-depth " << config.snapshotQueueDepth << "\n"
+        << "snapshot-overflow " << quoted(config.snapshotOverflow) << "\n"
+        << "snapshot-format " << quoted(config.snapshotFormat) << "\n"
+        << "snapshot-keyframe-interval " << config.snapshotKeyframeInterval << "\n"
+        << "retire-logs " << quoted(config.retireLogs) << "\n"
+        << "log-flush-ms " << config.logFlushMillis << "\n"
+        << "log-flush-bytes " << config.logFlushBytes << "\n"
+        << "log-tail-lines " << config.logTailLines << "\n"
+        << "trace-events " << (config.traceEvents ? 1 : 0) << "\n"
+        << "trace-buffer-events " << config.traceBufferEvents << "\n"
+        << "utilization-sample-ticks " << config.utilizationSampleTicks << "\n"
+        << "utilization-csv " << quoted(config.utilizationCsv) << "\n"
+        << "tick-ms " << config.tickMillis << "\n"
+        << "random-seed " << config.randomSeed << "\n";
+    if (!config.workloadRecord.empty()) out << "workload-record " << quoted(config.workloadRecord) << "\n";
+    if (!config.workloadReplay.empty()) out << "workload-replay " << quoted(config.workloadReplay) << "\n";
+}
@@ -1,18 +1,51 @@
 #pragma once
 #include <string>
 #include <cstdint>
+#include <istream>
+#include <ostream>
 
 struct SystemConfig {
     int numCPU = 1;
     std::string scheduler = "fcfs";
     uint32_t quantumCycles = 1;
     uint32_t batchProcessFreq = 1;
+    std::string arrivalDistribution = "constant";
+    uint32_t arrivalBurstSize = 8;
     uint32_t minInstructions = 1;
     uint32_t maxInstructions = 1;
     uint32_t delaysPerExec = 0;
     uint32_t maxOverallMem = 0;
     uint32_t memPerFrame = 0;
     uint32_t memPerProc = 0;
+    uint32_t minMemPerProc = 0;
+    uint32_t maxMemPerProc = 0;
+    std::string memAllocPolicy = "first-fit";
+    uint32_t compactionThreshold = 0;
+    uint32_t compactionBlocksPerPass = 4;
+    std::string memoryWaitOrder = "arrival";
+    uint32_t tlbEntries = 16;
+    uint32_t tlbWays = 4;
+    bool tlbAsid = true;
+    uint32_t tlbWalkCycles = 20;
+    uint32_t snapshotQueueDepth = 8;
+    std::string snapshotOverflow = "coalesce";
+    std::string snapshotFormat = "binary";
+    uint32_t snapshotKeyframeInterval = 64;
+    std::string retireLogs = "spill";
+    uint32_t logFlushMillis = 100;
+    uint32_t logFlushBytes = 256 * 1024;
+    uint32_t logTailLines = 32;
+    bool traceEvents = false;
+    uint32_t traceBufferEvents = 4096;
+    uint32_t utilizationSampleTicks = 100;
+    std::string utilizationCsv = "utilization.csv";
+    uint32_t tickMillis = 100;       // Worker sleep per CPU tick; 0 runs the cores flat out
+    uint32_t randomSeed = 0;        // 0 draws a fresh seed each initialize
+    std::string workloadRecord;     // Empty disables recording
+    std::string workloadReplay;     // Empty generates processes instead of replaying
 };
 
 bool readConfigFromFile(const std::string& filename, SystemConfig& config);
+bool readConfig(std::istream& file, SystemConfig& config);
+// Writes every key in config.txt syntax, so readConfig gets the same values back
+void writeConfig(std::ostream& out, const SystemConfig& config);
@@ -12,6 +12,7 @@
 #include <random>
 #include <mutex>
 #include <chrono>
+#include <bit>
 #ifdef _WIN32
 #include <conio.h>
 #ifndef NOMINMAX
@@ -28,21 +29,29 @@
 #include "ProcessInstruction.h"
 #include "MarqueeConsole.h"
 #include "FirstFitMemoryAllocator.h"
-#include <set>
+#include "MemorySnapshotWriter.h"
+#include "ProgramGenerator.h"
+#include "Workload.h"
+#include "ArrivalGenerator.h"
+#include "Checkpoint.h"
+#include "ProgramParser.h"
 #include <fstream>
+#include <sstream>
 
-extern std::atomic<uint64_t> cpuTickCount;
 class OpesyConsole {
 private:
-    std::unique_ptr<FirstFitMemoryAllocator> memoryAllocator;
-    int quantumCycle = 0;
+    MemorySnapshotWriter snapshotWriter; // Declared first so it outlives the scheduler thread
+    ProcessLogWriter logWriter;          // Likewise outlives the workers that log through it
+    UtilizationCsvWriter utilizationWriter;
 private:
-    ProcessManager processManager;
+    ProcessManager processManager{&logWriter};
     Scheduler scheduler{processManager};
     void setupMemorySnapshotCallback() {
-        scheduler.setMemorySnapshotCallback([this](uint64_t tick) { 
-            static int snapshotCounter = 1;
-            this->outputMemorySnapshot(snapshotCounter++); 
+        scheduler.setMemorySnapshotCallback([this](uint64_t snapshotNum) {
+            this->outputMemorySnapshot(static_cast<int>(snapshotNum));
+        });
+        scheduler.setUtilizationSampleCallback([this](const UtilizationSample& sample) {
+            utilizationWriter.submit(sample);
         });
     }
     SystemConfig config;
@@ -50,232 +59,142 @@ private:
     std::thread processGeneratorThread;
     std::atomic<bool> generating = false;
     int processCounter = 1;
-    std::mt19937 rng{std::random_device{}()};
+    ProgramGenerator programGenerator;
+    ProgramCache programCache;
+    WorkloadRecorder workloadRecorder;
+    WorkloadReader workloadReader;
+    WorkloadProcess pendingArrival;      // Read from the workload but not yet due
+    bool hasPendingArrival = false;
+    uint64_t workloadStartTick = 0;      // Arrival ticks count from the first scheduler-start
+    bool workloadClockStarted = false;
+    ArrivalGenerator arrivals;
+    uint32_t runSeed = 0;
     std::unique_ptr<MarqueeConsole> marqueeConsole;
+    bool scriptMode = false; // No screen clearing and no command that waits on stdin
 
     bool validateCommand(const std::string& command) {
         static const std::vector<std::string> validCommands = {
             "initialize", "screen -ls", "scheduler-start", "scheduler-stop", 
-            "report-util", "exit", "clear", "marquee"
+            "report-util", "exit", "clear", "marquee", "vmstat", "trace-dump", "latency", "profile", "reload",
+            "checkpoint", "restore"
         };
         return (command.rfind("screen -s ", 0) == 0 ||
+                command.rfind("screen -b ", 0) == 0 ||
                 command.rfind("screen -r ", 0) == 0 ||
+                command.rfind("trace-dump ", 0) == 0 ||
+                command.rfind("checkpoint ", 0) == 0 ||
+                command.rfind("restore ", 0) == 0 ||
                 std::find(validCommands.begin(), validCommands.end(), command) != validCommands.end());
     }
 
-void processGenerationLoop() {
-    static uint64_t lastProcessGenerationTick = 0;
-    
-    while (generating) {
-        uint64_t currentTick = cpuTickCount.load();
-        
-        // Generate process based on batch frequency
-        if (currentTick - lastProcessGenerationTick >= config.batchProcessFreq) {
-            lastProcessGenerationTick = currentTick;
-            std::ostringstream oss;
-            oss << "p" << std::setw(2) << std::setfill('0') << processCounter++;
-            std::string name = oss.str();
-            int pid = processManager.createProcess(name);
+    uint64_t workloadTick() const {
+        return workloadClockStarted ? scheduler.getCurrentTick() - workloadStartTick : 0;
+    }
+
+    // Memory first; the whole batch then reaches the scheduler under one lock
+    void admitBatch(const std::vector<int>& pids) {
+        if (pids.empty()) return;
+        auto memoryAllocator = scheduler.getMemoryAllocator();
+        std::vector<int> ready;
+        std::vector<std::pair<int, int>> waitingForMemory;
+        ready.reserve(pids.size());
+        for (int pid : pids) {
             Process* proc = processManager.getProcess(pid);
-            
-            if (proc) {
-                generateRandomInstructions(proc);
-                if (!memoryAllocator->allocate(pid)) {
-                    scheduler.addProcess(pid);
-                    continue;
-                }
-                scheduler.addProcess(pid);
+            if (!proc) continue;
+            if (memoryAllocator && !memoryAllocator->allocate(pid, proc->getMemorySize())) {
+                waitingForMemory.emplace_back(pid, proc->getMemorySize());
+            } else {
+                ready.push_back(pid);
             }
         }
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-    }
-}
-
-    void generateRandomInstructions(Process* proc) {
-        int instructionCount = std::uniform_int_distribution<int>(
-            config.minInstructions, config.maxInstructions)(rng);
-
-        std::vector<std::string> declaredVars;
-        std::vector<std::unique_ptr<IProcessInstruction>> instructions;
-
-        // Prepare DECLARE instructions
-        int numVars = std::max(1, std::uniform_int_distribution<int>(1, 3)(rng));
-        for (int v = 0; v < numVars; ++v) {
-            std::string var = "v" + std::to_string(v + 1);
-            uint16_t value = std::uniform_int_distribution<uint16_t>(0, 100)(rng);
-            declaredVars.push_back(var);
-            instructions.push_back(std::make_unique<DeclareInstruction>(var, value));
-        }
-
-        // Other instructions
-        int i = 0;
-        while (i < instructionCount) {
-            int choice = std::uniform_int_distribution<int>(0, 5)(rng);
-            switch (choice) {
-                case 0: // ADD
-                    if (!declaredVars.empty()) {
-                        // 3 variables to use
-                        std::string var1 = declaredVars.size() > 0 ? declaredVars[0] : "v1";
-                        std::string var2 = declaredVars.size() > 1 ? declaredVars[1] : "v2";
-                        std::string var3 = declaredVars.size() > 2 ? declaredVars[2] : "v3";
-                        instructions.push_back(std::make_unique<AddInstruction>(var1, var2, var3));
-                        ++i;
-                    }
-                    break;
-
-                case 1: // SUBTRACT
-                    if (!declaredVars.empty()) {
-                        std::string var1 = declaredVars.size() > 0 ? declaredVars[0] : "v1";
-                        std::string var2 = declaredVars.size() > 1 ? declaredVars[1] : "v2";
-                        std::string var3 = declaredVars.size() > 2 ? declaredVars[2] : "v3";
-                        instructions.push_back(std::make_unique<SubtractInstruction>(var1, var2, var3));
-                        ++i;
-                    }
-                    break;
-
-                case 2: // SLEEP
-                    {
-                        int ticks = std::uniform_int_distribution<int>(1, 5)(rng);
-                        instructions.push_back(std::make_unique<SleepInstruction>(ticks));
-                        ++i;
-                    }
-                    break;
-
-                case 3: // PRINT
-                    {
-                        std::string message = "Hello world from " + proc->getProcessName() + "!";
-                        instructions.push_back(std::make_unique<PrintInstruction>(message));
-                        ++i;
-                    }
-                    break;
-
-                case 4: // FOR
-                    if (i + 4 < instructionCount && !declaredVars.empty()) {
-                        int bodyCount = std::min(instructionCount - i - 2, std::uniform_int_distribution<int>(2, 3)(rng));
-                        std::vector<std::unique_ptr<IProcessInstruction>> bodyInstructions;
-                        for (int b = 0; b < bodyCount; ++b) {
-                            int bodyChoice = std::uniform_int_distribution<int>(0, 2)(rng);
-                            switch (bodyChoice) {
-                                case 0:
-                                    {
-                                        std::string var1 = declaredVars.size() > 0 ? declaredVars[0] : "v1";
-                                        std::string var2 = declaredVars.size() > 1 ? declaredVars[1] : "v2";
-                                        std::string var3 = declaredVars.size() > 2 ? declaredVars[2] : "v3";
-                                        bodyInstructions.push_back(std::make_unique<AddInstruction>(var1, var2, var3));
-                                    }
-                                    break;
-                                case 1:
-                                    {
-                                        std::string var1 = declaredVars.size() > 0 ? declaredVars[0] : "v1";
-                                        std::string var2 = declaredVars.size() > 1 ? declaredVars[1] : "v2";
-                                        std::string var3 = declaredVars.size() > 2 ? declaredVars[2] : "v3";
-                                        bodyInstructions.push_back(std::make_unique<SubtractInstruction>(var1, var2, var3));
-                                    }
-                                    break;
-                                default:
-                                    {
-                                        std::string message = "Hello world from " + proc->getProcessName() + "!";
-                                        bodyInstructions.push_back(std::make_unique<PrintInstruction>(message));
-                                    }
-                                    break;
-                            }
-                        }
-                        int repeats = std::uniform_int_distribution<int>(2, 4)(rng);
-                        instructions.push_back(std::make_unique<ForInstruction>(std::move(bodyInstructions), repeats));
-                        i += 2;
-                    } else {
-                        std::string message = "Hello world from " + proc->getProcessName() + "!";
-                        instructions.push_back(std::make_unique<PrintInstruction>(message));
-                        ++i;
-                    }
-                    break;
+        scheduler.addProcessBatch(ready, waitingForMemory);
+    }
 
-                default:
-                    {
-                        std::string message = "Hello world from " + proc->getProcessName() + "!";
-                        instructions.push_back(std::make_unique<PrintInstruction>(message));
-                        ++i;
-                    }
-                    break;
+    // Feeds the recorded arrivals in instead of generating; ends quietly when the file runs out
+    void replayWorkloadLoop() {
+        std::vector<int> batch;
+        while (generating) {
+            if (!hasPendingArrival) {
+                if (!workloadReader.next(pendingArrival)) break;
+                hasPendingArrival = true;
             }
+            if (workloadTick() < pendingArrival.arrivalTick) {
+                admitBatch(batch);
+                batch.clear();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            hasPendingArrival = false;
+            int pid = processManager.createProcess(pendingArrival.name);
+            Process* proc = processManager.getProcess(pid);
+            if (!proc) continue;
+            proc->setMemorySize(pendingArrival.memorySize);
+            for (auto& instruction : pendingArrival.program) {
+                proc->addInstruction(std::move(instruction));
+            }
+            pendingArrival.program.clear();
+            workloadRecorder.record(workloadTick(), *proc);
+            batch.push_back(pid);
         }
-
-        // Shuffle all instructions
-        std::shuffle(instructions.begin(), instructions.end(), rng);
-
-        // Add all instructions to the process
-        for (auto& instr : instructions) {
-            proc->addInstruction(std::move(instr));
-        }
+        admitBatch(batch);
     }
 
-    void generateAddInstruction(Process* proc, const std::vector<std::string>& vars) {
-        // 3 variables to use
-        std::string var1 = vars.size() > 0 ? vars[0] : "v1";
-        std::string var2 = vars.size() > 1 ? vars[1] : "v2";
-        std::string var3 = vars.size() > 2 ? vars[2] : "v3";
-        proc->addInstruction(std::make_unique<AddInstruction>(var1, var2, var3));
-    }
-
-    void generateSubtractInstruction(Process* proc, const std::vector<std::string>& vars) {
-        std::string var1 = vars.size() > 0 ? vars[0] : "v1";
-        std::string var2 = vars.size() > 1 ? vars[1] : "v2";
-        std::string var3 = vars.size() > 2 ? vars[2] : "v3";
-        proc->addInstruction(std::make_unique<SubtractInstruction>(var1, var2, var3));
-    }
-
-    void generateSleepInstruction(Process* proc) {
-        int ticks = std::uniform_int_distribution<int>(1, 5)(rng);
-        proc->addInstruction(std::make_unique<SleepInstruction>(ticks));
-    }
-
-    void generatePrintInstruction(Process* proc) {
-        std::string message = "Hello world from " + proc->getProcessName() + "!";
-        proc->addInstruction(std::make_unique<PrintInstruction>(message));
+    // Creates every process owed since the last check, then polls at half a tick
+    void processGenerationLoop() {
+        if (workloadReader.isOpen()) {
+            replayWorkloadLoop();
+            return;
+        }
+        // Reads the scheduler's published config, since reload replaces the console's copy on another thread
+        uint64_t appliedVersion = 0;
+        const SystemConfig* generatorConfig = nullptr;
+        std::vector<int> batch;
+        while (generating) {
+            if (!generatorConfig || scheduler.getConfigVersion() != appliedVersion) {
+                appliedVersion = scheduler.getConfigVersion();
+                generatorConfig = &scheduler.getConfig();
+                arrivals.reset(scheduler.getCurrentTick(), ArrivalGenerator::distributionFromString(generatorConfig->arrivalDistribution),
+                               generatorConfig->batchProcessFreq, generatorConfig->arrivalBurstSize, runSeed);
+            }
+            uint64_t due = arrivals.arrivalsUntil(scheduler.getCurrentTick());
+            for (uint64_t i = 0; i < due; ++i) {
+                std::ostringstream oss;
+                oss << "p" << std::setw(2) << std::setfill('0') << processCounter++;
+                int pid = processManager.createProcess(oss.str());
+                Process* proc = processManager.getProcess(pid);
+                if (!proc) continue;
+                proc->setMemorySize(programGenerator.drawMemorySize(*generatorConfig));
+                programGenerator.generate(proc, *generatorConfig);
+                workloadRecorder.record(workloadTick(), *proc);
+                batch.push_back(pid);
+            }
+            admitBatch(batch);
+            batch.clear();
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::max(uint32_t(1), generatorConfig->tickMillis / 2)));
+        }
     }
 
-    void generatePrintInstructionWithMessage(Process* proc, const std::string& processName, int lineNum) {
-        std::string message = "Hello world from " + processName + "!";
-        proc->addInstruction(std::make_unique<PrintInstruction>(message));
+    void startProcessGeneration() {
+        if (!workloadClockStarted) {
+            workloadStartTick = scheduler.getCurrentTick();
+            workloadClockStarted = true;
+        }
+        generating = true;
+        processGeneratorThread = std::thread(&OpesyConsole::processGenerationLoop, this);
     }
 
-    int generateForLoop(Process* proc, const std::vector<std::string>& vars, int maxBodyInstructions) {
-        int bodyCount = std::min(maxBodyInstructions, std::uniform_int_distribution<int>(2, 3)(rng));
-        std::vector<std::unique_ptr<IProcessInstruction>> bodyInstructions;
-        for (int b = 0; b < bodyCount; ++b) {
-            int bodyChoice = std::uniform_int_distribution<int>(0, 2)(rng);
-            switch (bodyChoice) {
-                case 0:
-                    {
-                        std::string var1 = vars.size() > 0 ? vars[0] : "v1";
-                        std::string var2 = vars.size() > 1 ? vars[1] : "v2";
-                        std::string var3 = vars.size() > 2 ? vars[2] : "v3";
-                        bodyInstructions.push_back(std::make_unique<AddInstruction>(var1, var2, var3));
-                    }
-                    break;
-                case 1:
-                    {
-                        std::string var1 = vars.size() > 0 ? vars[0] : "v1";
-                        std::string var2 = vars.size() > 1 ? vars[1] : "v2";
-                        std::string var3 = vars.size() > 2 ? vars[2] : "v3";
-                        bodyInstructions.push_back(std::make_unique<SubtractInstruction>(var1, var2, var3));
-                    }
-                    break;
-                default:
-                    {
-                        std::string message = "Hello world from " + proc->getProcessName() + "!";
-                        bodyInstructions.push_back(std::make_unique<PrintInstruction>(message));
-                    }
-                    break;
-            }
+    // Returns whether generation was running
+    bool stopProcessGeneration() {
+        if (!generating) return false;
+        generating = false;
+        if (processGeneratorThread.joinable()) {
+            processGeneratorThread.join();
         }
-        int repeats = std::uniform_int_distribution<int>(2, 4)(rng);
-        proc->addInstruction(std::make_unique<ForInstruction>(std::move(bodyInstructions), repeats));
-        return 1;
+        return true;
     }
 
     void clearScreen() {
+        if (scriptMode) return;
         #ifdef _WIN32
             system("cls");
         #else
@@ -284,8 +203,14 @@ void processGenerationLoop() {
     }
 
     void displayProcessInfo(const std::string& sessionName, int pid, bool showDetails = false) {
+        ProcessManager::ReadGuard guard(processManager);
         auto process = processManager.getProcess(pid);
-        if (!process) return;
+        if (!process) {
+            if (const RetiredProcess* retired = processManager.getRetiredProcess(pid)) {
+                displayRetiredProcessInfo(sessionName, pid, *retired, showDetails);
+            }
+            return;
+        }
 
         std::cout << "Process name: " << sessionName << std::endl;
 
@@ -310,36 +235,61 @@ void processGenerationLoop() {
         std::cout << std::endl;
     }
 
-    void outputProcessesByStatus(std::ostream& out, bool showRunning) const {
-        auto processes = processManager.getAllProcesses();
-        out << (showRunning ? "Running" : "Finished") << " processes:" << std::endl;
+    void displayRetiredProcessInfo(const std::string& sessionName, int pid, const RetiredProcess& retired, bool showDetails) {
+        std::cout << "Process name: " << sessionName << std::endl;
+        if (showDetails) {
+            std::cout << "ID: " << pid << std::endl;
+            std::cout << "Core: N/A" << std::endl;
+            std::cout << "CPU Utilization: " << retired.cpuUtilization << "%" << std::endl;
+        }
 
-        // Gather all PIDs currently assigned to a core
-        std::set<int> runningPIDs;
-        int totalCores = config.numCPU;
-        for (int i = 0; i < totalCores; ++i) {
-            int pid = scheduler.getCoreProcess(i);
-            if (pid != -1) runningPIDs.insert(pid);
+        std::cout << "ID: " << pid << std::endl;
+        std::cout << "Logs:" << std::endl;
+
+        std::string logs = retired.logs;
+        if (!retired.logFile.empty()) {
+            logWriter.flush(); // Its last lines may still be buffered
+            std::ifstream logFile(retired.logFile);
+            std::ostringstream contents;
+            contents << logFile.rdbuf();
+            logs = contents.str();
         }
+        std::cout << (logs.empty() ? "No logs available yet." : logs) << std::endl;
 
-        for (const auto& process : processes) {
-            if (showRunning) {
-                if (runningPIDs.count(process->getPID()) == 0) continue;
-            } else {
-                if (!process->isComplete()) continue;
-            }
-            auto timestamp = process->getTimestamp();
-            out << process->getProcessName() << "\t(" << timestamp << ")\t";
-            size_t currentLine = process->getCurrentInstructionNumber();
-            size_t totalLines = process->countEffectiveInstructions();
+        std::cout << "Finished!" << std::endl;
+        std::cout << "Finished at: " << retired.finishTimestamp
+                  << " | Turnaround: " << retired.turnaroundMillis << " ms"
+                  << " | Cores used: " << retired.coreMask.count()
+                  << " | Dispatches: " << retired.dispatchCount << std::endl;
+        std::cout << std::endl;
+    }
+
+    void outputProcessesByStatus(std::ostream& out, bool showRunning) const {
+        out << (showRunning ? "Running" : "Finished") << " processes:" << std::endl;
+
+        auto printProcess = [&](const Process& process, const ProcessStatus& status) {
+            auto timestamp = process.getTimestamp();
+            out << process.getProcessName() << "\t(" << timestamp << ")\t";
+            size_t totalLines = process.countEffectiveInstructions();
             if (showRunning) {
-                out << "Core: " << std::to_string(process->getCore())
-                    << "  " << currentLine << " / " << totalLines;
+                out << "Core: " << std::to_string(status.core)
+                    << "  " << status.currentLine << " / " << totalLines;
             } else {
                 out << "Finished " << totalLines << " / " << totalLines;
             }
             out << std::endl;
-        }
+        };
+
+        // One pass over published status records; workers keep running while we read
+        processManager.forEachProcess([&](const Process& process) {
+            ProcessStatus status = process.getStatus();
+            bool running = status.core >= 0 && !status.complete;
+            if (showRunning ? running : status.complete) printProcess(process, status);
+        }, [&](const RetiredProcess& retired) {
+            if (showRunning) return;
+            out << retired.name << "\t(" << retired.createdTimestamp << ")\t"
+                << "Finished " << retired.instructions << " / " << retired.instructions << std::endl;
+        });
         out << std::endl;
     }
 
@@ -360,20 +310,15 @@ void processGenerationLoop() {
         }
         else if (command == "scheduler-start") {
             if (!generating) {
-                generating = true;
-                processGeneratorThread = std::thread(&OpesyConsole::processGenerationLoop, this);
+                startProcessGeneration();
                 std::cout << "Dummy process generation started." << std::endl;
             } else {
                 std::cout << "Dummy process generation is already running." << std::endl;
             }
         }
         else if (command == "scheduler-stop") {
-            if (generating) {
-                generating = false;
-                if (processGeneratorThread.joinable()) {
-                    processGeneratorThread.join();
-                }
-            std::cout << "Dummy process generation stopped." << std::endl;
+            if (stopProcessGeneration()) {
+                std::cout << "Dummy process generation stopped." << std::endl;
             } else {
                 std::cout << "Dummy process generation is not running." << std::endl;
             }
@@ -381,14 +326,201 @@ void processGenerationLoop() {
         else if (command == "report-util") {
             generateUtilizationReport();
         }
+        else if (command == "reload") {
+            reloadConfig();
+        }
+        else if (command == "checkpoint" || command.rfind("checkpoint ", 0) == 0) {
+            writeCheckpoint(command.size() > 11 ? command.substr(11) : "csopesy.ckpt");
+        }
+        else if (command == "restore" || command.rfind("restore ", 0) == 0) {
+            restoreCheckpoint(command.size() > 8 ? command.substr(8) : "csopesy.ckpt");
+        }
         else if (command == "marquee") {
+            if (scriptMode) {
+                std::cout << "marquee needs an interactive terminal; skipped in script mode." << std::endl;
+                return;
+            }
             runMarqueeConsole();
         }
+        else if (command == "vmstat") {
+            displayVmstat();
+        }
+        else if (command == "profile") {
+            scheduler.printProfileReport(std::cout);
+        }
+        else if (command == "latency") {
+            std::ostringstream report;
+            scheduler.printLatencyReport(report);
+            std::cout << (report.str().empty() ? "No processes dispatched yet.\n" : report.str());
+        }
+        else if (command == "trace-dump" || command.rfind("trace-dump ", 0) == 0) {
+            std::string fileName = command.size() > 11 ? command.substr(11) : "scheduler-trace.json";
+            dumpSchedulerTrace(fileName);
+        }
         else {
             std::cout << command << " command recognized. Doing something." << std::endl;
         }
     }
 
+    // Re-reads config.txt into the running system. Keys that size memory, TLBs, buffers or output
+    // files keep their current values until the next initialize.
+    void reloadConfig() {
+        SystemConfig next;
+        if (!readConfigFromFile("config.txt", next)) {
+            std::cout << "Failed to reload config.txt; keeping the current configuration." << std::endl;
+            return;
+        }
+        std::vector<std::string> deferred;
+        auto keep = [&]<typename T>(const char* key, T SystemConfig::*field) {
+            if (next.*field != config.*field) {
+                deferred.push_back(key);
+                next.*field = config.*field;
+            }
+        };
+        keep("max-overall-mem", &SystemConfig::maxOverallMem);
+        keep("mem-per-frame", &SystemConfig::memPerFrame);
+        keep("mem-per-proc", &SystemConfig::memPerProc);
+        keep("min-mem-per-proc", &SystemConfig::minMemPerProc);
+        keep("mem-alloc-policy", &SystemConfig::memAllocPolicy);
+        keep("tlb-entries", &SystemConfig::tlbEntries);
+        keep("tlb-ways", &SystemConfig::tlbWays);
+        keep("tlb-asid", &SystemConfig::tlbAsid);
+        keep("tlb-walk-cycles", &SystemConfig::tlbWalkCycles);
+        keep("snapshot-queue-depth", &SystemConfig::snapshotQueueDepth);
+        keep("snapshot-overflow", &SystemConfig::snapshotOverflow);
+        keep("snapshot-format", &SystemConfig::snapshotFormat);
+        keep("snapshot-keyframe-interval", &SystemConfig::snapshotKeyframeInterval);
+        keep("log-flush-ms", &SystemConfig::logFlushMillis);
+        keep("log-flush-bytes", &SystemConfig::logFlushBytes);
+        keep("log-tail-lines", &SystemConfig::logTailLines);
+        keep("trace-buffer-events", &SystemConfig::traceBufferEvents);
+        keep("utilization-csv", &SystemConfig::utilizationCsv);
+        keep("random-seed", &SystemConfig::randomSeed);
+        keep("workload-record", &SystemConfig::workloadRecord);
+        keep("workload-replay", &SystemConfig::workloadReplay);
+
+        int previousCores = config.numCPU;
+        config = next;
+        if (auto memoryAllocator = scheduler.getMemoryAllocator()) {
+            memoryAllocator->setCompactionThreshold(config.compactionThreshold);
+        }
+        uint64_t version = scheduler.reloadConfig(config);
+        std::cout << "Reloaded config.txt as version " << version << ": " << config.scheduler
+                  << ", quantum " << config.quantumCycles << ", " << config.numCPU << " cores";
+        if (config.numCPU != previousCores) {
+            std::cout << " (" << (config.numCPU > previousCores ? "added " : "retired ")
+                      << std::abs(config.numCPU - previousCores) << ")";
+        }
+        std::cout << std::endl;
+        if (!deferred.empty()) {
+            std::cout << "Unchanged until the next initialize:";
+            for (const auto& key : deferred) std::cout << " " << key;
+            std::cout << std::endl;
+        }
+    }
+
+    // The cores and the generator stop only while state is encoded; the file is written after
+    // they resume. Everything restore needs is in the file, config included.
+    void writeCheckpoint(const std::string& fileName) {
+        auto started = std::chrono::steady_clock::now();
+        bool wasGenerating = stopProcessGeneration();
+        bool wasRunning = scheduler.isRunning();
+        scheduler.pause();
+
+        BinaryWriter out;
+        std::ostringstream configText;
+        writeConfig(configText, config);
+        out.putBytes(configText.str());
+        out.putVarint(runSeed);
+        out.putVarint(static_cast<uint64_t>(processCounter));
+        out.putByte(workloadClockStarted ? 1 : 0);
+        out.putVarint(workloadTick());
+        out.putByte(wasGenerating ? 1 : 0);
+        out.putBytes(programGenerator.saveState());
+        processManager.saveState(out, std::chrono::steady_clock::now());
+        auto memoryAllocator = scheduler.getMemoryAllocator();
+        out.putByte(memoryAllocator ? 1 : 0);
+        if (memoryAllocator) memoryAllocator->saveState(out);
+        scheduler.saveState(out);
+        size_t processes = processManager.getProcessCount();
+        uint64_t tick = scheduler.getCurrentTick();
+
+        if (wasRunning) scheduler.resume();
+        if (wasGenerating) startProcessGeneration();
+        auto paused = std::chrono::steady_clock::now() - started;
+
+        std::string error;
+        if (!writeCheckpointFile(fileName, out.data(), error)) {
+            std::cout << "Checkpoint failed: " << error << std::endl;
+            return;
+        }
+        auto millis = [](auto duration) { return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count(); };
+        std::cout << "Checkpoint of " << processes << " processes at tick " << tick << " written to " << fileName
+                  << " (" << out.size() << " bytes, paused " << millis(paused) << " ms, total "
+                  << millis(std::chrono::steady_clock::now() - started) << " ms)" << std::endl;
+    }
+
+    // Replaces the running simulation with the checkpointed one. Output writers and workload
+    // recording keep the settings from the last initialize.
+    void restoreCheckpoint(const std::string& fileName) {
+        auto started = std::chrono::steady_clock::now();
+        std::vector<char> body;
+        std::string error;
+        if (!readCheckpointFile(fileName, body, error)) {
+            std::cout << "Could not restore " << fileName << ": " << error << std::endl;
+            return;
+        }
+        BinaryReader in(body.data(), body.data() + body.size());
+        std::string configText, generatorState;
+        SystemConfig restored;
+        uint64_t seed = 0, counter = 0, savedTick = 0;
+        uint8_t clockStarted = 0, wasGenerating = 0;
+        bool headerRead = in.getBytes(configText) && in.getVarint(seed) && in.getVarint(counter) &&
+                          in.getByte(clockStarted) && in.getVarint(savedTick) && in.getByte(wasGenerating) &&
+                          in.getBytes(generatorState);
+        std::istringstream configStream(configText);
+        if (!headerRead || !readConfig(configStream, restored)) {
+            std::cout << "Could not restore " << fileName << ": bad checkpoint header" << std::endl;
+            return;
+        }
+
+        // Nothing has changed up to here; from now on a failure leaves the system uninitialized
+        stopProcessGeneration();
+        scheduler.stop();
+        config = restored;
+        auto now = std::chrono::steady_clock::now();
+        bool restoredOk = processManager.restoreState(in, now);
+        uint8_t hasAllocator = 0;
+        std::shared_ptr<FirstFitMemoryAllocator> memoryAllocator;
+        if (restoredOk && in.getByte(hasAllocator) && hasAllocator) {
+            memoryAllocator = std::make_shared<FirstFitMemoryAllocator>(config.maxOverallMem, config.minMemPerProc,
+                FirstFitMemoryAllocator::policyFromString(config.memAllocPolicy));
+            memoryAllocator->setCompactionThreshold(config.compactionThreshold);
+            restoredOk = memoryAllocator->restoreState(in);
+        }
+        scheduler.setMemoryAllocator(memoryAllocator);
+        scheduler.updateConfig(config);
+        restoredOk = restoredOk && scheduler.restoreState(in) && programGenerator.restoreState(generatorState);
+        if (!restoredOk) {
+            processManager.clear();
+            scheduler.setMemoryAllocator(nullptr);
+            initialized = false;
+            std::cout << "Restore from " << fileName << " failed partway; run initialize to start over." << std::endl;
+            return;
+        }
+
+        runSeed = static_cast<uint32_t>(seed);
+        processCounter = static_cast<int>(counter);
+        workloadClockStarted = clockStarted != 0;
+        workloadStartTick = scheduler.getCurrentTick() - savedTick;
+        scheduler.resume();
+        if (wasGenerating) startProcessGeneration();
+        std::cout << "Restored " << processManager.getProcessCount() << " processes at tick " << scheduler.getCurrentTick()
+                  << " from " << fileName << " in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count()
+                  << " ms" << (wasGenerating ? "; process generation resumed" : "") << std::endl;
+    }
+
     void runMarqueeConsole() {
         if (!marqueeConsole) {
             marqueeConsole = std::make_unique<MarqueeConsole>();
@@ -420,11 +552,15 @@ void processGenerationLoop() {
         logFile << "CPU utilization: " << cpuUtil << "%\n";
         logFile << "Cores used: " << usedCores << "\n";
         logFile << "Cores available: " << availableCores << "\n";
+        logFile << "Average CPU utilization: " << std::fixed << std::setprecision(1)
+                << scheduler.getAverageUtilization() << "%\n";
         logFile << std::endl;
         logFile << "----------------------------------------" << std::endl;
         outputProcessesByStatus(logFile, true);
         outputProcessesByStatus(logFile, false);
         logFile << "----------------------------------------" << std::endl;
+        logFile << "Scheduling latency:" << std::endl;
+        scheduler.printLatencyReport(logFile);
 
         logFile.close();
         std::cout << "Report generated at csopesy-log.txt" << std::endl;
@@ -442,6 +578,8 @@ void processGenerationLoop() {
         std::cout << "CPU utilization: " << cpuUtil << "%\n";
         std::cout << "Cores used: " << usedCores << "\n";
         std::cout << "Cores available: " << availableCores << "\n";
+        std::cout << "Average CPU utilization: " << std::fixed << std::setprecision(1)
+                  << scheduler.getAverageUtilization() << "%\n";
         std::cout << std::endl;
         std::cout << "----------------------------------------" << std::endl;
         const_cast<OpesyConsole*>(this)->displayProcessesByStatus(true);
@@ -449,10 +587,51 @@ void processGenerationLoop() {
         std::cout << "----------------------------------------" << std::endl;
     }
 
+    void dumpSchedulerTrace(const std::string& fileName) {
+        EventTracer& tracer = scheduler.getTracer();
+        if (!tracer.isEnabled()) {
+            std::cout << "Event tracing is off (set trace-events 1 in config.txt)." << std::endl;
+            return;
+        }
+        std::ofstream out(fileName);
+        if (!out) {
+            std::cout << "Could not open " << fileName << std::endl;
+            return;
+        }
+        size_t events = tracer.writeChromeTrace(out, [this](int pid) {
+            ProcessManager::ReadGuard guard(processManager);
+            if (const Process* process = processManager.getProcess(pid)) return process->getProcessName();
+            const RetiredProcess* retired = processManager.getRetiredProcess(pid);
+            return retired ? retired->name : "pid " + std::to_string(pid);
+        });
+        std::cout << "Wrote " << events << " events to " << fileName << " (open in ui.perfetto.dev)" << std::endl;
+    }
+
+    void displayVmstat() {
+        const SystemConfig& schedulerConfig = scheduler.getConfig();
+        std::cout << "TLB: " << schedulerConfig.tlbEntries << " entries, " << schedulerConfig.tlbWays << "-way, "
+                  << (schedulerConfig.tlbAsid ? "ASID tagged" : "flush on context switch")
+                  << ", walk cost " << schedulerConfig.tlbWalkCycles << " cycles\n\n";
+        std::cout << "core    accesses        hit%     miss%    walk cycles   flushes\n";
+        auto printRow = [](const std::string& label, const TlbStats& stats) {
+            std::cout << std::left << std::setw(8) << label << std::right
+                      << std::setw(10) << stats.accesses()
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(11) << stats.hitRate()
+                      << std::setw(10) << stats.missRate()
+                      << std::setw(15) << stats.walkCycles
+                      << std::setw(10) << stats.flushes << "\n";
+        };
+        for (int core = 0; core < scheduler.getNumCores(); ++core) {
+            printRow(std::to_string(core), scheduler.getCoreTlbStats(core));
+        }
+        printRow("total", scheduler.getTotalTlbStats());
+    }
+
     void sessionLoop(const std::string& sessionName, int pid) {
-        auto process = processManager.getProcess(pid);
-        if (!process) return;
+        if (!processManager.getProcess(pid) && !processManager.getRetiredProcess(pid)) return;
         std::string input;
+        bool released = false;
         clearScreen();
         while (true) {
             displayProcessInfo(sessionName, pid, false);
@@ -473,8 +652,19 @@ void processGenerationLoop() {
                 std::cout << "Invalid command." << std::endl;
             }
 
-            if (process->isComplete()) {
-                memoryAllocator->release(pid);
+            bool complete;
+            {
+                ProcessManager::ReadGuard guard(processManager);
+                const Process* process = processManager.getProcess(pid);
+                complete = !process || process->isComplete();
+            }
+            if (complete) {
+                if (!released) {
+                    if (auto memoryAllocator = scheduler.getMemoryAllocator()) {
+                        memoryAllocator->release(pid);
+                    }
+                    released = true;
+                }
                 clearScreen();
                 displayProcessInfo(sessionName, pid, false);
                 std::cout << "Process completed." << std::endl;
@@ -484,54 +674,108 @@ void processGenerationLoop() {
         }
     }
 
-void outputMemorySnapshot(int quantumCycle) {
-    std::string dirName = "memory_stamps";
-    
-    std::filesystem::create_directory(dirName);
-    
-    std::ostringstream filename;
-    filename << dirName << "/memory_stamp_" << std::setw(2) << std::setfill('0') << quantumCycle << ".txt";
-    
-    std::ofstream out(filename.str());
-    if (!out.is_open()) {
-        std::cerr << "Failed to create memory snapshot file: " << filename.str() << std::endl;
-        return;
-    }
-    
-    // Timestamp
-    std::time_t now = std::time(nullptr);
-    char buf[64];
-    std::strftime(buf, sizeof(buf), "%d/%m/%Y %I:%M:%S%p", std::localtime(&now));
-    out << "Timestamp: (" << buf << ")\n";
-    out << "Number of processes in memory: " << memoryAllocator->getNumProcessesInMemory() << "\n";
-    out << "Total external fragmentation in KB: " << (memoryAllocator->getExternalFragmentation() / 1024) << "\n\n";
-    memoryAllocator->printMemory(out);
-    out.close();
+    // Runs on the scheduler thread, so it only captures state; the writer thread does the I/O
+    void outputMemorySnapshot(int snapshotNum) {
+        auto memoryAllocator = scheduler.getMemoryAllocator();
+        if (!memoryAllocator) return;
+        MemoryStampRecord record;
+        record.stampNumber = snapshotNum;
+        record.capturedAt = std::time(nullptr);
+        record.memory = memoryAllocator->getSnapshot();
+        record.policy = memoryAllocator->getPolicy();
+        record.waitingForMemory = scheduler.getMemoryWaitQueueSize();
+        record.tlb = scheduler.getTotalTlbStats();
+        snapshotWriter.submit(std::move(record));
     }
 
 
+    // "screen -b <prefix> <count> <file>": count processes named prefix-1.. that all run one
+    // cached copy of the program, admitted together like a generator batch
+    void createProgramBatch(const std::string& args) {
+        std::istringstream in(args);
+        std::string prefix, programFile;
+        long long count = 0;
+        if (!(in >> prefix >> count) || !std::getline(in >> std::ws, programFile) || programFile.empty() || count <= 0) {
+            std::cout << "Usage: screen -b <prefix> <count> <file>" << std::endl;
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::string error;
+        bool cached = false;
+        auto program = programCache.load(programFile, error, &cached);
+        if (!program) {
+            std::cout << "Error: " << error << std::endl;
+            return;
+        }
+        auto loaded = std::chrono::steady_clock::now();
+        std::vector<int> batch;
+        batch.reserve(static_cast<size_t>(count));
+        for (long long i = 1; i <= count; ++i) {
+            int pid = processManager.createProcess(prefix + "-" + std::to_string(i));
+            Process* proc = processManager.getProcess(pid);
+            if (!proc) continue;
+            proc->setMemorySize(programGenerator.drawMemorySize(config));
+            proc->setProgram(program);
+            workloadRecorder.record(workloadTick(), *proc);
+            batch.push_back(pid);
+        }
+        admitBatch(batch);
+        auto done = std::chrono::steady_clock::now();
+        auto micros = [](auto duration) { return std::chrono::duration_cast<std::chrono::microseconds>(duration).count(); };
+        std::cout << "Created " << batch.size() << " processes from " << programFile << " ("
+                  << program->instructions.size() << " instructions, "
+                  << (cached ? "cached" : "parsed in " + std::to_string(micros(loaded - start)) + " us")
+                  << ", created in " << micros(done - loaded) << " us)" << std::endl;
+    }
+
+    // "screen -s <name> [file]": a random program, or the one in file
     bool handleScreenCommand(const std::string& command) {
         if (command.rfind("screen -s ", 0) == 0) {
-            std::string processName = command.substr(10);
+            std::istringstream args(command.substr(10));
+            std::string processName, programFile;
+            args >> processName;
+            std::getline(args >> std::ws, programFile);
+            std::shared_ptr<const CompiledProgram> program;
+            if (!programFile.empty()) {
+                std::string error;
+                program = programCache.load(programFile, error);
+                if (!program) {
+                    std::cout << "Error: " << error << std::endl;
+                    return true;
+                }
+            }
             int pid = processManager.createProcess(processName);
             Process* proc = processManager.getProcess(pid);
             if (proc) {
-                generateRandomInstructions(proc);
+                proc->setMemorySize(programGenerator.drawMemorySize(config));
+                if (program) {
+                    proc->setProgram(program);
+                } else {
+                    programGenerator.generate(proc, config);
+                }
+                workloadRecorder.record(workloadTick(), *proc);
             }
             
             std::cout << "Created screen session '" << processName << "'" << std::endl;
             scheduler.addProcess(pid);
-            sessionLoop(processName, pid);
+            if (!scriptMode) sessionLoop(processName, pid);
+            return true;
+        }
+        if (command.rfind("screen -b ", 0) == 0) {
+            createProgramBatch(command.substr(10));
             return true;
         }
         if (command.rfind("screen -r ", 0) == 0) {
             std::string processName = command.substr(10);
-            auto processes = processManager.getAllProcesses();
-            for (const auto& process : processes) {
-                if (process->getProcessName() == processName) {
-                    sessionLoop(processName, process->getPID());
-                    return true;
+            int pid = processManager.findProcessByName(processName);
+            if (pid != -1) {
+                // Scripts get one process-smi style snapshot instead of an interactive session
+                if (scriptMode) {
+                    displayProcessInfo(processName, pid, true);
+                } else {
+                    sessionLoop(processName, pid);
                 }
+                return true;
             }
             std::cout << "Screen session '" << processName << "' does not exist." << std::endl;
             return true;
@@ -540,29 +784,49 @@ void outputMemorySnapshot(int quantumCycle) {
     }
 
     void processCommand(const std::string& command) {
-        static bool snapshotCallbackSet = false;
-        if (!snapshotCallbackSet) { setupMemorySnapshotCallback(); snapshotCallbackSet = true; }
         if (handleScreenCommand(command)) return;
         if (command == "exit") {
             std::cout << "Exiting CSOPESY CLI..." << std::endl;
-            if (generating) {
-                generating = false;
-                if (processGeneratorThread.joinable()) {
-                    processGeneratorThread.join();
-                }
-            }
+            stopProcessGeneration();
             scheduler.stop();
+            if (initialized) {
+                std::cout << "\nScheduler profile:\n";
+                scheduler.printProfileReport(std::cout);
+            }
+            snapshotWriter.stop();
+            logWriter.stop();
+            utilizationWriter.stop();
+            workloadRecorder.close();
             exit(0);
         }
 
         if (command == "initialize") {
             initialized = readConfigFromFile("config.txt", config);
             if (initialized) {
-                quantumCycle = 0;
-                memoryAllocator = std::make_unique<FirstFitMemoryAllocator>(config.maxOverallMem, config.memPerProc);
-globalMemoryAllocator = memoryAllocator.get();
-                memoryAllocator = std::make_unique<FirstFitMemoryAllocator>(config.maxOverallMem, config.memPerProc);
-globalMemoryAllocator = memoryAllocator.get();
+                auto newAllocator = std::make_shared<FirstFitMemoryAllocator>(config.maxOverallMem, config.minMemPerProc,
+                    FirstFitMemoryAllocator::policyFromString(config.memAllocPolicy));
+                newAllocator->setCompactionThreshold(config.compactionThreshold);
+                scheduler.setMemoryAllocator(newAllocator);
+                snapshotWriter.start(config.snapshotQueueDepth,
+                    config.snapshotOverflow == "drop" ? SnapshotOverflowPolicy::DROP : SnapshotOverflowPolicy::COALESCE,
+                    config.snapshotFormat == "binary", config.snapshotKeyframeInterval);
+                logWriter.start(config.logFlushMillis, config.logFlushBytes, config.logTailLines);
+                if (config.utilizationSampleTicks > 0 && !utilizationWriter.start(config.utilizationCsv, 500)) {
+                    std::cout << "Warning: Could not open " << config.utilizationCsv << "\n";
+                }
+                uint32_t seed = config.randomSeed ? config.randomSeed : std::random_device{}();
+                if (!config.workloadReplay.empty()) {
+                    if (workloadReader.open(config.workloadReplay)) {
+                        seed = workloadReader.getSeed();
+                    } else {
+                        std::cout << "Warning: Could not read workload " << config.workloadReplay << "\n";
+                    }
+                }
+                programGenerator.reseed(seed);
+                runSeed = seed;
+                if (!config.workloadRecord.empty() && !workloadRecorder.open(config.workloadRecord, seed)) {
+                    std::cout << "Warning: Could not open " << config.workloadRecord << "\n";
+                }
                 scheduler.updateConfig(config);
                 scheduler.start();
                 
@@ -571,12 +835,39 @@ globalMemoryAllocator = memoryAllocator.get();
                 std::cout << "scheduler: " << config.scheduler << '\n';
                 std::cout << "quantum-cycles: " << config.quantumCycles << '\n';
                 std::cout << "batch-process-freq: " << config.batchProcessFreq << '\n';
+                std::cout << "arrival-distribution: " << config.arrivalDistribution << '\n';
+                std::cout << "arrival-burst-size: " << config.arrivalBurstSize << '\n';
                 std::cout << "min-ins: " << config.minInstructions << '\n';
                 std::cout << "max-ins: " << config.maxInstructions << '\n';
                 std::cout << "delay-per-exec: " << config.delaysPerExec << '\n';
                 std::cout << "max-overall-mem: " << config.maxOverallMem << '\n';
                 std::cout << "mem-per-frame: " << config.memPerFrame << '\n';
-                std::cout << "mem-per-proc: " << config.memPerProc << "\n\n";
+                std::cout << "min-mem-per-proc: " << config.minMemPerProc << '\n';
+                std::cout << "max-mem-per-proc: " << config.maxMemPerProc << '\n';
+                std::cout << "mem-alloc-policy: " << config.memAllocPolicy << '\n';
+                std::cout << "compaction-threshold: " << config.compactionThreshold << '\n';
+                std::cout << "compaction-blocks-per-pass: " << config.compactionBlocksPerPass << '\n';
+                std::cout << "memory-wait-order: " << config.memoryWaitOrder << '\n';
+                std::cout << "tlb-entries: " << config.tlbEntries << '\n';
+                std::cout << "tlb-ways: " << config.tlbWays << '\n';
+                std::cout << "tlb-asid: " << config.tlbAsid << '\n';
+                std::cout << "tlb-walk-cycles: " << config.tlbWalkCycles << '\n';
+                std::cout << "snapshot-queue-depth: " << config.snapshotQueueDepth << '\n';
+                std::cout << "snapshot-overflow: " << config.snapshotOverflow << '\n';
+                std::cout << "snapshot-format: " << config.snapshotFormat << '\n';
+                std::cout << "snapshot-keyframe-interval: " << config.snapshotKeyframeInterval << '\n';
+                std::cout << "retire-logs: " << config.retireLogs << '\n';
+                std::cout << "log-flush-ms: " << config.logFlushMillis << '\n';
+                std::cout << "log-flush-bytes: " << config.logFlushBytes << '\n';
+                std::cout << "log-tail-lines: " << config.logTailLines << '\n';
+                std::cout << "trace-events: " << config.traceEvents << '\n';
+                std::cout << "trace-buffer-events: " << config.traceBufferEvents << '\n';
+                std::cout << "utilization-sample-ticks: " << config.utilizationSampleTicks << '\n';
+                std::cout << "utilization-csv: " << config.utilizationCsv << '\n';
+                std::cout << "tick-ms: " << config.tickMillis << '\n';
+                std::cout << "random-seed: " << seed << '\n';
+                std::cout << "workload-record: " << (config.workloadRecord.empty() ? "off" : config.workloadRecord) << '\n';
+                std::cout << "workload-replay: " << (config.workloadReplay.empty() ? "off" : config.workloadReplay) << "\n\n";
             } else {
                 std::cout << "Failed to initialize from config.txt\n";
             }
@@ -601,6 +892,10 @@ globalMemoryAllocator = memoryAllocator.get();
     }
 
 public:
+    OpesyConsole() {
+        setupMemorySnapshotCallback();
+    }
+
     void run() {
         std::string command;
         displayHeader();
@@ -611,6 +906,55 @@ public:
             processCommand(command);
         }
     }
+
+    // Runs a command file unattended; "at <tick> <command>" first waits for that CPU tick.
+    // Blank lines and lines starting with # are skipped, and the run ends with exit.
+    int runScript(const std::string& path) {
+        std::ifstream script(path);
+        if (!script.is_open()) {
+            std::cerr << "Error: Could not open script " << path << "\n";
+            return 1;
+        }
+        scriptMode = true;
+        displayHeader();
+
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(script, line)) {
+            ++lineNumber;
+            line.erase(0, line.find_first_not_of(" \t"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (line.empty() || line[0] == '#') continue;
+
+            if (line.rfind("at ", 0) == 0) {
+                std::istringstream parts(line.substr(3));
+                uint64_t tick;
+                if (!(parts >> tick) || !std::getline(parts >> std::ws, line) || line.empty()) {
+                    std::cout << path << ":" << lineNumber << ": expected 'at <tick> <command>'" << std::endl;
+                    continue;
+                }
+                waitForTick(tick);
+            }
+            std::cout << "[tick " << scheduler.getCurrentTick() << "] " << line << std::endl;
+            processCommand(line);
+        }
+        processCommand("exit");
+        return 0;
+    }
+
+private:
+    void waitForTick(uint64_t tick) {
+        // Ticks only advance while the scheduler runs, so waiting before initialize would hang
+        if (!scheduler.isRunning()) {
+            if (scheduler.getCurrentTick() < tick) {
+                std::cout << "Warning: scheduler not running; not waiting for tick " << tick << std::endl;
+            }
+            return;
+        }
+        while (scheduler.getCurrentTick() < tick) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "EventTracer.h"
+#include <algorithm>
+#include <map>
+
+namespace {
+    size_t roundUpToPowerOfTwo(size_t n) {
+        size_t capacity = 1;
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
+
+    std::string jsonEscape(const std::string& text) {
+        std::string escaped;
+        escaped.reserve(text.size());
+        for (char c : text) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            if (static_cast<unsigned char>(c) < 0x20) continue;
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    // Scheduler thread is track 0, core N is track N + 1
+    int trackFor(int core) {
+        return core < 0 ? 0 : core + 1;
+    }
+}
+
+EventTracer::~EventTracer() {
+    for (auto& ring : rings) {
+        delete ring.load();
+    }
+}
+
+void EventTracer::configure(bool on, int numCores, size_t perRing) {
+    size_t capacity = roundUpToPowerOfTwo(std::max(size_t(2), perRing));
+    if (capacity != eventsPerRing.exchange(capacity)) {
+        // A thread may still be writing into an old ring, so it is parked rather than freed
+        for (auto& ring : rings) {
+            if (Ring* old = ring.exchange(nullptr, std::memory_order_acq_rel)) retiredRings.emplace_back(old);
+        }
+    }
+    for (int core = SCHEDULER_RING; core < numCores; ++core) {
+        ringFor(core);
+    }
+    setEnabled(on);
+}
+
+EventTracer::Ring* EventTracer::ringFor(int ring) {
+    size_t index = static_cast<size_t>(ring + 1);
+    if (index >= MAX_RINGS) return nullptr;
+    Ring* existing = rings[index].load(std::memory_order_acquire);
+    if (existing) return existing;
+    Ring* created = new Ring(eventsPerRing.load());
+    if (rings[index].compare_exchange_strong(existing, created, std::memory_order_acq_rel)) {
+        return created;
+    }
+    delete created;
+    return existing;
+}
+
+void EventTracer::recordEvent(int ring, TraceEventType type, int pid, int core, int arg) {
+    Ring* target = ringFor(ring);
+    if (!target) return;
+    uint64_t index = target->head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = target->slots[index & target->mask];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event.tick = tickSource ? tickSource->load(std::memory_order_relaxed) : 0;
+    slot.event.timeNanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - origin).count());
+    slot.event.pid = pid;
+    slot.event.core = core;
+    slot.event.arg = arg;
+    slot.event.type = type;
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+std::vector<TraceEvent> EventTracer::collect() const {
+    std::vector<TraceEvent> events;
+    for (const auto& ringPtr : rings) {
+        const Ring* ring = ringPtr.load(std::memory_order_acquire);
+        if (!ring) continue;
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t first = head > ring->slots.size() ? head - ring->slots.size() : 0;
+        for (uint64_t index = first; index < head; ++index) {
+            const Slot& slot = ring->slots[index & ring->mask];
+            uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before != 2 * index + 2) continue; // Not yet published, or already overwritten
+            TraceEvent event = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != before) continue;
+            events.push_back(event);
+        }
+    }
+    std::sort(events.begin(), events.end(),
+        [](const TraceEvent& a, const TraceEvent& b) { return a.timeNanos < b.timeNanos; });
+    return events;
+}
+
+const char* EventTracer::eventName(TraceEventType type) {
+    switch (type) {
+        case TraceEventType::DISPATCH: return "dispatch";
+        case TraceEventType::PREEMPT: return "preempt";
+        case TraceEventType::SLEEP: return "sleep";
+        case TraceEventType::WAKE: return "wake";
+        case TraceEventType::COMPLETE: return "complete";
+        case TraceEventType::MEMORY_ALLOC_FAIL: return "memory-alloc-fail";
+        case TraceEventType::SNAPSHOT: return "snapshot";
+    }
+    return "unknown";
+}
+
+size_t EventTracer::writeChromeTrace(std::ostream& out, const std::function<std::string(int)>& processName) const {
+    std::vector<TraceEvent> events = collect();
+    bool firstEntry = true;
+    auto beginEntry = [&]() -> std::ostream& {
+        out << (firstEntry ? "\n" : ",\n");
+        firstEntry = false;
+        return out;
+    };
+    auto micros = [](uint64_t nanos) { return nanos / 1000.0; };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    std::map<int, bool> tracks{{0, true}};
+    for (const auto& event : events) {
+        tracks[trackFor(event.core)] = true;
+    }
+    for (const auto& [track, used] : tracks) {
+        std::string name = track == 0 ? "Scheduler" : "Core " + std::to_string(track - 1);
+        beginEntry() << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << track
+                     << ",\"args\":{\"name\":\"" << name << "\"}}";
+    }
+
+    // A dispatch opens a run slice on its core; the next preempt, sleep, complete or dispatch closes it
+    std::map<int, const TraceEvent*> openRuns;
+    auto closeRun = [&](int track, uint64_t endNanos) {
+        auto it = openRuns.find(track);
+        if (it == openRuns.end()) return;
+        const TraceEvent& start = *it->second;
+        beginEntry() << "{\"ph\":\"X\",\"name\":\"" << jsonEscape(processName(start.pid))
+                     << "\",\"pid\":1,\"tid\":" << track << ",\"ts\":" << micros(start.timeNanos)
+                     << ",\"dur\":" << micros(endNanos - start.timeNanos)
+                     << ",\"args\":{\"pid\":" << start.pid << ",\"tick\":" << start.tick << "}}";
+        openRuns.erase(it);
+    };
+
+    for (const auto& event : events) {
+        int track = trackFor(event.core);
+        bool endsRun = event.type == TraceEventType::PREEMPT || event.type == TraceEventType::SLEEP ||
+                       event.type == TraceEventType::COMPLETE || event.type == TraceEventType::DISPATCH;
+        if (event.core >= 0 && endsRun) closeRun(track, event.timeNanos);
+        if (event.core >= 0 && event.type == TraceEventType::DISPATCH) openRuns[track] = &event;
+
+        beginEntry() << "{\"ph\":\"i\",\"s\":\"t\",\"name\":\"" << eventName(event.type)
+                     << "\",\"pid\":1,\"tid\":" << track << ",\"ts\":" << micros(event.timeNanos)
+                     << ",\"args\":{\"pid\":" << event.pid << ",\"tick\":" << event.tick
+                     << ",\"arg\":" << event.arg << "}}";
+    }
+    uint64_t lastNanos = events.empty() ? 0 : events.back().timeNanos;
+    while (!openRuns.empty()) {
+        closeRun(openRuns.begin()->first, lastNanos);
+    }
+    out << "\n]}\n";
+    return events.size();
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class TraceEventType : uint8_t {
+    DISPATCH,
+    PREEMPT,
+    SLEEP,
+    WAKE,
+    COMPLETE,
+    MEMORY_ALLOC_FAIL,
+    SNAPSHOT
+};
+
+struct TraceEvent {
+    uint64_t tick = 0;
+    uint64_t timeNanos = 0; // Since the tracer was configured
+    int32_t pid = -1;
+    int32_t core = -1;      // -1 for events not tied to a core
+    int32_t arg = 0;        // Memory size, sleep ticks or stamp number
+    TraceEventType type = TraceEventType::DISPATCH;
+};
+
+// Scheduling event recorder. Each core has its own fixed-size ring, plus one shared ring for the
+// scheduler and console threads; a full ring overwrites its oldest events. Writers claim a slot
+// with one fetch_add and publish it through a per-slot sequence, so recording never blocks and
+// readers can skip a slot that is being rewritten. When tracing is off, record() is one branch.
+class EventTracer {
+public:
+    static constexpr int SCHEDULER_RING = -1;
+
+    EventTracer() = default;
+    ~EventTracer();
+    EventTracer(const EventTracer&) = delete;
+    EventTracer& operator=(const EventTracer&) = delete;
+
+    // Rings are created on demand and never freed, so this is safe while other threads record.
+    // A new ring size replaces the rings, dropping the events recorded so far.
+    void configure(bool enabled, int numCores, size_t eventsPerRing);
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    // Counter stamped on each event; the owning scheduler's tick
+    void setTickSource(const std::atomic<uint64_t>* ticks) { tickSource = ticks; }
+
+    void record(int ring, TraceEventType type, int pid, int core, int arg = 0) {
+        if (!enabled.load(std::memory_order_relaxed)) [[likely]] return;
+        recordEvent(ring, type, pid, core, arg);
+    }
+
+    std::vector<TraceEvent> collect() const;
+    // Chrome trace JSON (chrome://tracing, ui.perfetto.dev): one track per core, runs as slices
+    size_t writeChromeTrace(std::ostream& out, const std::function<std::string(int)>& processName) const;
+    static const char* eventName(TraceEventType type);
+private:
+    static constexpr size_t MAX_RINGS = 257;
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0}; // 2 * index + 2 once written, odd while being written
+        TraceEvent event;
+    };
+
+    struct Ring {
+        explicit Ring(size_t capacity) : slots(capacity), mask(capacity - 1) {}
+        std::vector<Slot> slots;
+        size_t mask;
+        std::atomic<uint64_t> head{0};
+    };
+
+    std::atomic<bool> enabled{false};
+    const std::atomic<uint64_t>* tickSource = nullptr;
+    std::atomic<size_t> eventsPerRing{4096};
+    std::array<std::atomic<Ring*>, MAX_RINGS> rings{};
+    std::vector<std::unique_ptr<Ring>> retiredRings; // Replaced by configure, kept until destruction
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+    void recordEvent(int ring, TraceEventType type, int pid, int core, int arg);
+    Ring* ringFor(int ring);
+};
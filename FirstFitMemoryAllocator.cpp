@@ -1,98 +1,482 @@
 #include "FirstFitMemoryAllocator.h"
 #include <iostream>
 
-FirstFitMemoryAllocator* globalMemoryAllocator = nullptr;
 #include <algorithm>
 #include <iomanip>
 #include <ctime>
 #include <sstream>
+#include <bit>
+#include <climits>
+#include <chrono>
 
-FirstFitMemoryAllocator::FirstFitMemoryAllocator(int totalMem, int memPerProc)
-    : totalMemory(totalMem), memPerProc(memPerProc) {
-    freeBlocks.push_back(Block(0, totalMem));
+FirstFitMemoryAllocator::FirstFitMemoryAllocator(int totalMem, int memPerProc, PlacementPolicy policy)
+    : totalMemory(totalMem), memPerProc(memPerProc), policy(policy) {
+    addFreeBlock(0, totalMem);
+}
+
+FirstFitMemoryAllocator::~FirstFitMemoryAllocator() {
+    PendingRelease* node = pendingReleases.exchange(nullptr);
+    while (node) {
+        PendingRelease* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+PlacementPolicy FirstFitMemoryAllocator::policyFromString(const std::string& name) {
+    if (name == "best-fit") return PlacementPolicy::BEST_FIT;
+    if (name == "next-fit") return PlacementPolicy::NEXT_FIT;
+    if (name == "worst-fit") return PlacementPolicy::WORST_FIT;
+    return PlacementPolicy::FIRST_FIT;
+}
+
+const char* FirstFitMemoryAllocator::policyName(PlacementPolicy policy) {
+    switch (policy) {
+        case PlacementPolicy::BEST_FIT: return "best-fit";
+        case PlacementPolicy::NEXT_FIT: return "next-fit";
+        case PlacementPolicy::WORST_FIT: return "worst-fit";
+        default: return "first-fit";
+    }
+}
+
+int FirstFitMemoryAllocator::sizeClassOf(int size) {
+    int cls = static_cast<int>(std::bit_width(static_cast<uint32_t>(size))) - 1;
+    return std::clamp(cls, 0, NUM_SIZE_CLASSES - 1);
+}
+
+void FirstFitMemoryAllocator::addFreeBlock(int start, int size) {
+    if (size <= 0) return;
+    int cls = sizeClassOf(size);
+    freeByStart[start] = size;
+    sizeClasses[cls].insert({size, start});
+    classByStart[cls].emplace(start, size);
+    freeMemory += size;
+    if (size < memPerProc) smallFreeBytes += size;
+    nonEmptyClasses |= (1u << cls);
+}
+
+void FirstFitMemoryAllocator::removeFreeBlock(int start, int size) {
+    int cls = sizeClassOf(size);
+    freeByStart.erase(start);
+    sizeClasses[cls].erase({size, start});
+    classByStart[cls].erase(start);
+    freeMemory -= size;
+    if (size < memPerProc) smallFreeBytes -= size;
+    if (sizeClasses[cls].empty()) {
+        nonEmptyClasses &= ~(1u << cls);
+    }
+}
+
+// Merges the freed range with its address neighbours before indexing it
+void FirstFitMemoryAllocator::insertAndCoalesce(int start, int size) {
+    auto next = freeByStart.lower_bound(start);
+    if (next != freeByStart.end() && start + size == next->first) {
+        int nextStart = next->first, nextSize = next->second;
+        removeFreeBlock(nextStart, nextSize);
+        size += nextSize;
+    }
+    auto prev = freeByStart.lower_bound(start);
+    if (prev != freeByStart.begin()) {
+        --prev;
+        if (prev->first + prev->second == start) {
+            int prevStart = prev->first, prevSize = prev->second;
+            removeFreeBlock(prevStart, prevSize);
+            start = prevStart;
+            size += prevSize;
+        }
+    }
+    addFreeBlock(start, size);
+}
+
+int FirstFitMemoryAllocator::getLargestFreeBlock() {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    drainPendingReleases();
+    return largestFreeBlockLocked();
+}
+
+int FirstFitMemoryAllocator::getFreeMemory() {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    drainPendingReleases();
+    return freeMemory;
+}
+
+int FirstFitMemoryAllocator::largestFreeBlockLocked() const {
+    if (nonEmptyClasses == 0) return 0;
+    int cls = 31 - std::countl_zero(nonEmptyClasses);
+    return sizeClasses[cls].rbegin()->first;
+}
+
+// Lowest-addressed block at or after from that holds size. Every block in a class above the
+// request's fits, so those classes only need their lowest start; the request's own class is
+// walked in address order, and only below the best start found so far
+int FirstFitMemoryAllocator::findLowestFit(int size, int from) const {
+    int cls = sizeClassOf(size);
+    int best = INT_MAX;
+    uint32_t higher = (cls + 1 < NUM_SIZE_CLASSES) ? (nonEmptyClasses >> (cls + 1)) << (cls + 1) : 0;
+    while (higher != 0) {
+        int found = std::countr_zero(higher);
+        higher &= higher - 1;
+        auto it = classByStart[found].lower_bound(from);
+        if (it != classByStart[found].end()) best = std::min(best, it->first);
+    }
+    for (auto it = classByStart[cls].lower_bound(from); it != classByStart[cls].end() && it->first < best; ++it) {
+        if (it->second >= size) return it->first;
+    }
+    return best == INT_MAX ? -1 : best;
+}
+
+int FirstFitMemoryAllocator::findFirstFit(int size) const {
+    return findLowestFit(size, 0);
+}
+
+int FirstFitMemoryAllocator::findBestFit(int size) const {
+    int cls = sizeClassOf(size);
+    // The request's own class may hold blocks that are too small, so search it by size
+    auto it = sizeClasses[cls].lower_bound({size, INT_MIN});
+    if (it != sizeClasses[cls].end()) return it->second;
+    // Every block in a higher class fits; the smallest one is the first of the lowest class
+    uint32_t higher = (cls + 1 < NUM_SIZE_CLASSES) ? (nonEmptyClasses >> (cls + 1)) : 0;
+    if (higher == 0) return -1;
+    int found = cls + 1 + std::countr_zero(higher);
+    return sizeClasses[found].begin()->second;
+}
+
+int FirstFitMemoryAllocator::findNextFit(int size) const {
+    if (largestFreeBlockLocked() < size) return -1;
+    int start = findLowestFit(size, nextFitRover);
+    return start >= 0 ? start : findLowestFit(size, 0);
+}
+
+int FirstFitMemoryAllocator::findWorstFit(int size) const {
+    if (nonEmptyClasses == 0) return -1;
+    int cls = 31 - std::countl_zero(nonEmptyClasses);
+    const auto& largest = *sizeClasses[cls].rbegin();
+    return largest.first >= size ? largest.second : -1;
 }
 
 bool FirstFitMemoryAllocator::allocate(int processId) {
-    for (size_t i = 0; i < freeBlocks.size(); ++i) {
-        Block& block = freeBlocks[i];
-        if (block.size >= memPerProc) {
-            allocatedBlocks.push_back(AllocatedBlock(processId, block.start, memPerProc));
-            if (block.size == memPerProc) {
-                freeBlocks.erase(freeBlocks.begin() + i);
-            } else {
-                block.start += memPerProc;
-                block.size -= memPerProc;
-            }
-            return true;
+    return allocate(processId, memPerProc);
+}
+
+bool FirstFitMemoryAllocator::allocate(int processId, int size) {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    drainPendingReleases();
+    if (allocatedBlocks.count(processId) > 0) return true;
+    if (size <= 0) size = memPerProc;
+
+    int start = -1;
+    switch (policy) {
+        case PlacementPolicy::FIRST_FIT: start = findFirstFit(size); break;
+        case PlacementPolicy::BEST_FIT: start = findBestFit(size); break;
+        case PlacementPolicy::NEXT_FIT: start = findNextFit(size); break;
+        case PlacementPolicy::WORST_FIT: start = findWorstFit(size); break;
+    }
+    if (start < 0) {
+        ++allocationFailures;
+        // Enough memory exists, it is just scattered across holes
+        if (freeMemory >= size) {
+            compactionRequested = true;
         }
+        version.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
-    return false;
+
+    int blockSize = freeByStart.at(start);
+    removeFreeBlock(start, blockSize);
+    if (blockSize > size) {
+        addFreeBlock(start + size, blockSize - size);
+    }
+    allocatedBlocks.emplace(processId, AllocatedBlock(processId, start, size));
+    allocatedByStart.emplace(start, processId);
+    nextFitRover = start + size;
+    version.fetch_add(1, std::memory_order_relaxed);
+    return true;
 }
 
+// Never blocks: applied in place when the allocator is idle, otherwise queued for the lock holder
 void FirstFitMemoryAllocator::release(int processId) {
-    auto it = std::find_if(allocatedBlocks.begin(), allocatedBlocks.end(), [processId](const AllocatedBlock& ab) {
-        return ab.processId == processId;
-    });
-    if (it != allocatedBlocks.end()) {
-        freeBlocks.push_back(Block(it->start, it->size));
-        allocatedBlocks.erase(it);
-        mergeFreeBlocks();
+    std::unique_lock<std::mutex> lock(allocatorMutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+        drainPendingReleases();
+        if (releaseLocked(processId)) {
+            releaseEpoch.fetch_add(1);
+            version.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+    PendingRelease* node = new PendingRelease{processId, pendingReleases.load(std::memory_order_relaxed)};
+    while (!pendingReleases.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    // The holder may have drained just before the push; retry so the node is not left behind
+    if (lock.try_lock()) {
+        drainPendingReleases();
     }
 }
 
-bool FirstFitMemoryAllocator::isAllocated(int processId) const {
-    return std::any_of(allocatedBlocks.begin(), allocatedBlocks.end(), [processId](const AllocatedBlock& ab) {
-        return ab.processId == processId;
-    });
+bool FirstFitMemoryAllocator::releaseLocked(int processId) {
+    auto it = allocatedBlocks.find(processId);
+    if (it == allocatedBlocks.end()) return false;
+    insertAndCoalesce(it->second.start, it->second.size);
+    allocatedByStart.erase(it->second.start);
+    allocatedBlocks.erase(it);
+    return true;
 }
 
-void FirstFitMemoryAllocator::mergeFreeBlocks() {
-    if (freeBlocks.empty()) return;
-    std::sort(freeBlocks.begin(), freeBlocks.end(), [](const Block& a, const Block& b) { return a.start < b.start; });
-    std::vector<Block> merged;
-    merged.push_back(freeBlocks[0]);
-    for (size_t i = 1; i < freeBlocks.size(); ++i) {
-        Block& last = merged.back();
-        if (last.start + last.size == freeBlocks[i].start) {
-            last.size += freeBlocks[i].size;
-        } else {
-            merged.push_back(freeBlocks[i]);
-        }
+bool FirstFitMemoryAllocator::drainPendingReleases() {
+    PendingRelease* node = pendingReleases.exchange(nullptr, std::memory_order_acquire);
+    bool changed = false;
+    while (node) {
+        changed |= releaseLocked(node->processId);
+        PendingRelease* next = node->next;
+        delete node;
+        node = next;
+    }
+    if (changed) {
+        releaseEpoch.fetch_add(1);
+        version.fetch_add(1, std::memory_order_relaxed);
+    }
+    return changed;
+}
+
+bool FirstFitMemoryAllocator::isAllocated(int processId) {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    drainPendingReleases();
+    return allocatedBlocks.count(processId) > 0;
+}
+
+int FirstFitMemoryAllocator::getBlockStart(int processId) {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    auto it = allocatedBlocks.find(processId);
+    return it != allocatedBlocks.end() ? it->second.start : -1;
+}
+
+// Caller holds allocatorMutex
+std::shared_ptr<MemorySnapshot> FirstFitMemoryAllocator::buildSnapshotLocked() const {
+    auto snapshot = std::make_shared<MemorySnapshot>();
+    snapshot->blocks.reserve(allocatedBlocks.size());
+    for (const auto& [pid, ab] : allocatedBlocks) {
+        snapshot->blocks.push_back(ab);
+    }
+    snapshot->freeBlocks.reserve(freeByStart.size());
+    for (const auto& [start, size] : freeByStart) {
+        snapshot->freeBlocks.push_back(Block(start, size));
+    }
+    snapshot->externalFragmentation = smallFreeBytes;
+    snapshot->allocationFailures = allocationFailures;
+    snapshot->compactionBytesMoved = compactionBytesMoved;
+    snapshot->compactionTimeMicros = compactionTimeNanos / 1000;
+    snapshot->compactionsCompleted = compactionsCompleted;
+    snapshot->version = version.load(std::memory_order_relaxed);
+    snapshot->totalMemory = totalMemory;
+    return snapshot;
+}
+
+// Only stamp writers and printMemory pay for the copy, and only once per change
+std::shared_ptr<const MemorySnapshot> FirstFitMemoryAllocator::getSnapshot() const {
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        if (published && published->version == version.load(std::memory_order_relaxed)) return published;
     }
-    freeBlocks = std::move(merged);
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    auto snapshot = buildSnapshotLocked();
+    std::lock_guard<std::mutex> cacheLock(snapshotMutex);
+    if (!published || published->version < snapshot->version) published = snapshot;
+    return snapshot;
 }
 
 int FirstFitMemoryAllocator::getExternalFragmentation() const {
-    int frag = 0;
-    for (const Block& b : freeBlocks) {
-        if (b.size < memPerProc) {
-            frag += b.size;
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    return smallFreeBytes;
+}
+
+uint64_t FirstFitMemoryAllocator::getAllocationFailures() const {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    return allocationFailures;
+}
+
+uint64_t FirstFitMemoryAllocator::getCompactionBytesMoved() const {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    return compactionBytesMoved;
+}
+
+uint64_t FirstFitMemoryAllocator::getCompactionTimeMicros() const {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    return compactionTimeNanos / 1000;
+}
+
+uint64_t FirstFitMemoryAllocator::getCompactionsCompleted() const {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    return compactionsCompleted;
+}
+
+int FirstFitMemoryAllocator::getFragmentationPercent() {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    drainPendingReleases();
+    if (freeMemory == 0) return 0;
+    return (freeMemory - largestFreeBlockLocked()) * 100 / freeMemory;
+}
+
+int FirstFitMemoryAllocator::compactStep(int maxBlocks, const std::function<bool(int)>& canMove) {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    drainPendingReleases();
+    if (!compactionActive) {
+        int threshold = compactionThreshold.load();
+        bool overThreshold = threshold > 0 && freeMemory > 0 &&
+            (freeMemory - largestFreeBlockLocked()) * 100 / freeMemory >= threshold;
+        bool stalled = compactionStalled && compactionStalledEpoch == releaseEpoch.load();
+        if (!compactionRequested && (!overThreshold || stalled)) {
+            return 0;
+        }
+        compactionActive = true;
+        compactionRequested = false;
+        compactionStalled = false;
+        compactionFrontier = 0;
+        compactionPassMoved = 0;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    int visited = 0, moved = 0;
+    auto it = allocatedByStart.lower_bound(compactionFrontier);
+    while (it != allocatedByStart.end() && visited < maxBlocks) {
+        ++visited;
+        int start = it->first;
+        int pid = it->second;
+        AllocatedBlock& ab = allocatedBlocks.at(pid);
+
+        // Releases may land anywhere, so look up the hole ending at this block directly
+        auto hole = freeByStart.lower_bound(start);
+        bool hasHole = false;
+        if (hole != freeByStart.begin()) {
+            --hole;
+            hasHole = hole->first + hole->second == start;
+        }
+        if (!hasHole || !canMove(pid)) {
+            // Already packed, or pinned by a running process; pack the rest behind it
+            compactionFrontier = start + ab.size;
+            ++it;
+            continue;
+        }
+
+        int holeStart = hole->first;
+        int gap = hole->second;
+        removeFreeBlock(holeStart, gap);
+        it = allocatedByStart.erase(it);
+        ab.start = holeStart;
+        allocatedByStart.emplace(ab.start, pid);
+        insertAndCoalesce(ab.start + ab.size, gap);
+        compactionBytesMoved += ab.size;
+        compactionFrontier = ab.start + ab.size;
+        ++moved;
+    }
+
+    if (moved > 0) {
+        releaseEpoch.fetch_add(1);
+    }
+    compactionPassMoved += moved;
+    if (it == allocatedByStart.end()) {
+        compactionActive = false;
+        ++compactionsCompleted;
+        if (compactionPassMoved == 0) {
+            // Pinned blocks left the holes where they were; only a release can change that
+            compactionStalled = true;
+            compactionStalledEpoch = releaseEpoch.load();
         }
     }
-    return frag;
+    compactionTimeNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+    version.fetch_add(1, std::memory_order_relaxed);
+    return moved;
+}
+
+void FirstFitMemoryAllocator::saveState(BinaryWriter& out) {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    drainPendingReleases();
+    out.putVarint(static_cast<uint64_t>(totalMemory));
+    out.putVarint(allocatedByStart.size());
+    for (const auto& [start, pid] : allocatedByStart) {
+        out.putVarint(static_cast<uint64_t>(pid));
+        out.putVarint(static_cast<uint64_t>(start));
+        out.putVarint(static_cast<uint64_t>(allocatedBlocks.at(pid).size));
+    }
+    out.putVarint(static_cast<uint64_t>(nextFitRover));
+    out.putVarint(allocationFailures);
+    out.putByte((compactionRequested.load() ? 1 : 0) | (compactionActive.load() ? 2 : 0));
+    out.putVarint(static_cast<uint64_t>(compactionFrontier));
+    out.putVarint(compactionBytesMoved);
+    out.putVarint(compactionTimeNanos);
+    out.putVarint(compactionsCompleted);
+}
+
+bool FirstFitMemoryAllocator::restoreState(BinaryReader& in) {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    drainPendingReleases();
+    uint64_t savedTotal, count;
+    if (!in.getVarint(savedTotal) || savedTotal != static_cast<uint64_t>(totalMemory) || !in.getVarint(count)) {
+        return false;
+    }
+    std::map<int, std::pair<int, int>> blocks; // start -> (pid, size)
+    for (uint64_t i = 0; i < count; ++i) {
+        int pid, start, size;
+        if (!in.getVarint(pid) || !in.getVarint(start) || !in.getVarint(size)) return false;
+        blocks.emplace(start, std::make_pair(pid, size));
+    }
+    uint8_t flags;
+    if (!in.getVarint(nextFitRover) || !in.getVarint(allocationFailures) || !in.getByte(flags) ||
+        !in.getVarint(compactionFrontier) || !in.getVarint(compactionBytesMoved) ||
+        !in.getVarint(compactionTimeNanos) || !in.getVarint(compactionsCompleted)) {
+        return false;
+    }
+
+    freeByStart.clear();
+    for (auto& sizeClass : sizeClasses) sizeClass.clear();
+    for (auto& sizeClass : classByStart) sizeClass.clear();
+    nonEmptyClasses = 0;
+    freeMemory = 0;
+    allocatedBlocks.clear();
+    allocatedByStart.clear();
+    int cursor = 0;
+    for (const auto& [start, entry] : blocks) {
+        if (start < cursor || start + entry.second > totalMemory) return false; // Overlapping or out of range
+        addFreeBlock(cursor, start - cursor);
+        allocatedBlocks.emplace(entry.first, AllocatedBlock(entry.first, start, entry.second));
+        allocatedByStart.emplace(start, entry.first);
+        cursor = start + entry.second;
+    }
+    addFreeBlock(cursor, totalMemory - cursor);
+    compactionRequested = flags & 1;
+    compactionActive = flags & 2;
+    compactionPassMoved = 0;
+    compactionStalled = false;
+    releaseEpoch.fetch_add(1); // Memory waiters should look again
+    version.fetch_add(1, std::memory_order_relaxed);
+    return true;
 }
 
 int FirstFitMemoryAllocator::getNumProcessesInMemory() const {
-    return (int)allocatedBlocks.size();
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    return static_cast<int>(allocatedBlocks.size());
 }
 
 void FirstFitMemoryAllocator::printMemory(std::ostream& out) const {
-    std::vector<AllocatedBlock> sortedBlocks = allocatedBlocks;
+    printMemorySnapshot(out, *getSnapshot());
+}
+
+void printMemorySnapshot(std::ostream& out, const MemorySnapshot& snapshot) {
+    std::vector<AllocatedBlock> sortedBlocks = snapshot.blocks;
     std::sort(sortedBlocks.begin(), sortedBlocks.end(), [](const AllocatedBlock& a, const AllocatedBlock& b) {
         return a.start > b.start;
     });
-    int lastAddr = totalMemory;
-    out << "----end---- = " << totalMemory << "\n\n";
+    out << "----end---- = " << snapshot.totalMemory << "\n\n";
     for (const auto& ab : sortedBlocks) {
-        out << lastAddr << "\n";
+        out << ab.start + ab.size << "\n";
         out << "P" << ab.processId << "\n";
         out << ab.start << "\n\n";
-        lastAddr = ab.start;
     }
     out << "----start----- = 0\n";
 }
 
 void FirstFitMemoryAllocator::getMemorySnapshot(std::vector<AllocatedBlock>& outBlocks, std::vector<Block>& outFreeBlocks) const {
-    outBlocks = allocatedBlocks;
-    outFreeBlocks = freeBlocks;
+    auto snapshot = getSnapshot();
+    outBlocks = snapshot->blocks;
+    outFreeBlocks = snapshot->freeBlocks;
 }
@@ -2,9 +2,16 @@
 #include <vector>
 #include <ostream>
 #include <map>
-
-class FirstFitMemoryAllocator;
-extern FirstFitMemoryAllocator* globalMemoryAllocator;
+#include <set>
+#include <array>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "BinaryCodec.h"
 
 struct Block {
     int start;
@@ -19,20 +26,122 @@ struct AllocatedBlock {
     AllocatedBlock(int pid, int s, int sz) : processId(pid), start(s), size(sz) {}
 };
 
+enum class PlacementPolicy {
+    FIRST_FIT,
+    BEST_FIT,
+    NEXT_FIT,
+    WORST_FIT
+};
+
+// Immutable view of the allocator, built on demand when it changed since the last one
+struct MemorySnapshot {
+    std::vector<AllocatedBlock> blocks;
+    std::vector<Block> freeBlocks;
+    int externalFragmentation = 0;
+    uint64_t allocationFailures = 0;
+    uint64_t compactionBytesMoved = 0;
+    uint64_t compactionTimeMicros = 0;
+    uint64_t compactionsCompleted = 0;
+    uint64_t version = 0;
+    int totalMemory = 0;
+};
+
+// Writes the stamp's block layout, highest address first
+void printMemorySnapshot(std::ostream& out, const MemorySnapshot& snapshot);
+
 class FirstFitMemoryAllocator {
 public:
-    FirstFitMemoryAllocator(int totalMem, int memPerProc);
-    bool isAllocated(int processId) const;
+    FirstFitMemoryAllocator(int totalMem, int memPerProc, PlacementPolicy policy = PlacementPolicy::FIRST_FIT);
+    ~FirstFitMemoryAllocator();
+    bool isAllocated(int processId);
+    int getBlockStart(int processId);
     bool allocate(int processId);
+    bool allocate(int processId, int size);
     void release(int processId);
     int getExternalFragmentation() const;
     int getNumProcessesInMemory() const;
+    int getLargestFreeBlock();
+    uint64_t getAllocationFailures() const;
+    int getFreeMemory();
+    int getFragmentationPercent();
+    PlacementPolicy getPolicy() const { return policy; }
     void printMemory(std::ostream& out) const;
     void getMemorySnapshot(std::vector<AllocatedBlock>& outBlocks, std::vector<Block>& outFreeBlocks) const;
+    std::shared_ptr<const MemorySnapshot> getSnapshot() const;
+    // Bumped whenever memory is freed or moved, so waiters know when a retry can succeed
+    uint64_t getReleaseEpoch() const { return releaseEpoch.load(); }
+
+    // Compaction slides blocks toward address 0, a bounded number of blocks per call
+    void setCompactionThreshold(int percent) { compactionThreshold.store(percent); }
+    void requestCompaction() { compactionRequested.store(true); }
+    bool isCompacting() const { return compactionActive.load(); }
+    int compactStep(int maxBlocks, const std::function<bool(int)>& canMove);
+    uint64_t getCompactionBytesMoved() const;
+    uint64_t getCompactionTimeMicros() const;
+    uint64_t getCompactionsCompleted() const;
+
+    // Checkpoint form: the allocated blocks plus counters; free blocks are the gaps between them.
+    // Restore expects an allocator built with the same total memory and fails otherwise.
+    void saveState(BinaryWriter& out);
+    bool restoreState(BinaryReader& in);
+
+    static PlacementPolicy policyFromString(const std::string& name);
+    static const char* policyName(PlacementPolicy policy);
 private:
+    // Free blocks are segregated by floor(log2(size)); class k holds sizes in [2^k, 2^(k+1))
+    static constexpr int NUM_SIZE_CLASSES = 32;
+
+    // Lock-free stack of releases that found allocatorMutex busy; the holder applies them
+    struct PendingRelease {
+        int processId;
+        PendingRelease* next;
+    };
+
     int totalMemory;
-    int memPerProc;
-    std::vector<Block> freeBlocks;
-    std::vector<AllocatedBlock> allocatedBlocks;
-    void mergeFreeBlocks();
+    int memPerProc; // Smallest process size, used as the fragmentation threshold
+    PlacementPolicy policy;
+    mutable std::mutex allocatorMutex; // Guards the free and allocated indexes below
+    std::map<int, int> freeByStart; // start -> size, address ordered for coalescing
+    std::array<std::set<std::pair<int, int>>, NUM_SIZE_CLASSES> sizeClasses; // (size, start)
+    std::array<std::map<int, int>, NUM_SIZE_CLASSES> classByStart; // Same blocks, start -> size, for first/next-fit
+    uint32_t nonEmptyClasses = 0;
+    int nextFitRover = 0;
+    uint64_t allocationFailures = 0;
+    std::unordered_map<int, AllocatedBlock> allocatedBlocks;
+    std::map<int, int> allocatedByStart; // start -> pid
+    int freeMemory = 0;
+    int smallFreeBytes = 0; // In holes smaller than memPerProc, i.e. external fragmentation
+    std::atomic<PendingRelease*> pendingReleases{nullptr};
+    std::atomic<uint64_t> releaseEpoch{0};
+
+    std::atomic<int> compactionThreshold{0}; // Percent of free memory outside the largest hole; 0 disables
+    std::atomic<bool> compactionRequested{false};
+    std::atomic<bool> compactionActive{false};
+    int compactionFrontier = 0; // Everything below this address is already packed
+    int compactionPassMoved = 0;
+    // A threshold pass that moved nothing waits for releaseEpoch to change before trying again
+    bool compactionStalled = false;
+    uint64_t compactionStalledEpoch = 0;
+    uint64_t compactionBytesMoved = 0;
+    uint64_t compactionTimeNanos = 0;
+    uint64_t compactionsCompleted = 0;
+
+    // Mutations only bump version; getSnapshot() copies the indexes when the cached one is stale
+    mutable std::mutex snapshotMutex; // Only guards the cached pointer, never allocator work
+    mutable std::shared_ptr<const MemorySnapshot> published;
+    std::atomic<uint64_t> version{1};
+
+    static int sizeClassOf(int size);
+    void addFreeBlock(int start, int size);
+    void removeFreeBlock(int start, int size);
+    void insertAndCoalesce(int start, int size);
+    int findLowestFit(int size, int from) const;
+    int findFirstFit(int size) const;
+    int findBestFit(int size) const;
+    int findNextFit(int size) const;
+    int findWorstFit(int size) const;
+    int largestFreeBlockLocked() const;
+    bool releaseLocked(int processId);
+    bool drainPendingReleases();
+    std::shared_ptr<MemorySnapshot> buildSnapshotLocked() const;
 };
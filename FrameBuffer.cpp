@@ -0,0 +1,117 @@
+#include "FrameBuffer.h"
+#include <algorithm>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {
+    // Unchanged cells shorter than this between two changes are resent rather than skipped,
+    // since a cursor move costs about as many bytes
+    constexpr int MIN_SKIP = 8;
+}
+
+void FrameBuffer::resize(int newWidth, int newHeight) {
+    width = std::max(1, newWidth);
+    height = std::max(1, newHeight);
+    back.assign(static_cast<size_t>(width) * height, ' ');
+    front.assign(back.size(), ' ');
+    fullRedraw = true;
+}
+
+void FrameBuffer::clear() {
+    std::fill(back.begin(), back.end(), ' ');
+}
+
+void FrameBuffer::put(int x, int y, std::string_view text) {
+    if (y < 0 || y >= height || x >= width) return;
+    if (x < 0) {
+        if (static_cast<size_t>(-x) >= text.size()) return;
+        text.remove_prefix(static_cast<size_t>(-x));
+        x = 0;
+    }
+    size_t count = std::min(text.size(), static_cast<size_t>(width - x));
+    char* row = back.data() + static_cast<size_t>(y) * width;
+    for (size_t i = 0; i < count; ++i) {
+        char c = text[i];
+        row[x + i] = (static_cast<unsigned char>(c) < 0x20) ? ' ' : c;
+    }
+}
+
+void FrameBuffer::setCursor(int x, int y) {
+    cursorX = std::clamp(x, 0, width - 1);
+    cursorY = std::clamp(y, 0, height - 1);
+}
+
+void FrameBuffer::moveTo(int x, int y) {
+    out += "\033[";
+    out += std::to_string(y + 1);
+    out += ';';
+    out += std::to_string(x + 1);
+    out += 'H';
+}
+
+size_t FrameBuffer::present() {
+    out.clear();
+    if (fullRedraw) {
+        out += "\033[2J";
+        std::fill(front.begin(), front.end(), '\0'); // Forces every cell to differ
+        fullRedraw = false;
+    }
+    for (int y = 0; y < height; ++y) {
+        const char* next = back.data() + static_cast<size_t>(y) * width;
+        char* shown = front.data() + static_cast<size_t>(y) * width;
+        int x = 0;
+        while (x < width) {
+            if (next[x] == shown[x]) {
+                ++x;
+                continue;
+            }
+            // Extend the run across short stretches of unchanged cells
+            int end = x + 1;
+            int lastChanged = x;
+            while (end < width && end - lastChanged <= MIN_SKIP) {
+                if (next[end] != shown[end]) lastChanged = end;
+                ++end;
+            }
+            moveTo(x, y);
+            out.append(next + x, static_cast<size_t>(lastChanged - x + 1));
+            std::copy(next + x, next + lastChanged + 1, shown + x);
+            x = lastChanged + 1;
+        }
+    }
+    moveTo(cursorX, cursorY);
+    writeOut();
+    return out.size();
+}
+
+void FrameBuffer::writeOut() {
+#ifdef _WIN32
+    static bool virtualTerminal = [] {
+        HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode = 0;
+        return GetConsoleMode(console, &mode) &&
+               SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }();
+    (void)virtualTerminal;
+    DWORD written = 0;
+    WriteFile(GetStdHandle(STD_OUTPUT_HANDLE), out.data(), static_cast<DWORD>(out.size()), &written, nullptr);
+#else
+    const char* data = out.data();
+    size_t remaining = out.size();
+    while (remaining > 0) {
+        ssize_t written = write(STDOUT_FILENO, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+#endif
+}
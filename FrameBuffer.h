@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+// Character grid for full-screen terminal output. Callers draw the whole frame into the back
+// buffer; present() compares it with what is already on screen and sends only the changed runs
+// of cells, plus the cursor position, as a single write.
+class FrameBuffer {
+public:
+    // The next present() clears the terminal and redraws everything
+    void resize(int newWidth, int newHeight);
+    // Likewise, for when something else has written to the terminal
+    void invalidate() { fullRedraw = true; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    void clear();
+    // Clipped to the buffer
+    void put(int x, int y, std::string_view text);
+    void setCursor(int x, int y);
+
+    // Returns the number of bytes written
+    size_t present();
+
+private:
+    int width = 0;
+    int height = 0;
+    std::vector<char> back;
+    std::vector<char> front; // What the terminal shows now
+    bool fullRedraw = true;
+    int cursorX = 0;
+    int cursorY = 0;
+    std::string out;         // Reused every frame
+
+    void moveTo(int x, int y);
+    void writeOut();
+};
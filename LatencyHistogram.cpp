@@ -0,0 +1,46 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram()
+    : counts(SUB_BUCKET_COUNT + (64 - SUB_BUCKET_BITS) * SUB_BUCKET_HALF, 0) {}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) return static_cast<size_t>(value);
+    int shift = std::bit_width(value) - SUB_BUCKET_BITS;
+    // value >> shift lies in [SUB_BUCKET_HALF, SUB_BUCKET_COUNT)
+    return static_cast<size_t>(SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF + ((value >> shift) - SUB_BUCKET_HALF));
+}
+
+uint64_t LatencyHistogram::bucketHighestValue(size_t index) {
+    if (index < SUB_BUCKET_COUNT) return index;
+    size_t offset = index - SUB_BUCKET_COUNT;
+    int shift = static_cast<int>(offset / SUB_BUCKET_HALF) + 1;
+    uint64_t sub = SUB_BUCKET_HALF + offset % SUB_BUCKET_HALF;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    ++counts[bucketIndex(value)];
+    ++count;
+    sum += value;
+    maxValue = std::max(maxValue, value);
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    count = sum = maxValue = 0;
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+    if (count == 0) return 0;
+    double clamped = std::clamp(percentile, 0.0, 100.0);
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * count)));
+    uint64_t seen = 0;
+    for (size_t index = 0; index < counts.size(); ++index) {
+        seen += counts[index];
+        if (seen >= target) return std::min(bucketHighestValue(index), maxValue);
+    }
+    return maxValue;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear histogram in the style of HdrHistogram: values below 2^SUB_BUCKET_BITS are exact,
+// larger ones land in one of 64 sub-buckets per power of two, so any percentile is within ~1.6%.
+// Memory is fixed (a few KB) no matter how many values are recorded. Not thread safe.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+    void record(uint64_t value);
+    void reset();
+    uint64_t getCount() const { return count; }
+    uint64_t getMax() const { return maxValue; }
+    double getMean() const { return count == 0 ? 0.0 : static_cast<double>(sum) / count; }
+    // Highest value of the bucket holding the given percentile (0-100)
+    uint64_t getPercentile(double percentile) const;
+private:
+    static constexpr int SUB_BUCKET_BITS = 7;
+    static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t(1) << SUB_BUCKET_BITS;
+    static constexpr uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+
+    std::vector<uint64_t> counts;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t maxValue = 0;
+
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketHighestValue(size_t index);
+};
@@ -9,8 +9,15 @@ Iral II, John Rovere N.
 Angeles, Marc Andrei D.
 */
 
-int main() {
+int main(int argc, char* argv[]) {
     OpesyConsole console;
+    if (argc == 3 && std::string(argv[1]) == "--script") {
+        return console.runScript(argv[2]);
+    }
+    if (argc > 1) {
+        std::cerr << "Usage: csopesy [--script <file>]\n";
+        return 1;
+    }
     console.run();
     
     return 0;
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+// Read-only view of a whole file. The file is memory-mapped, so parsing it costs no copy; if
+// mapping fails (pipes, some network drives) it is read into memory instead.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    std::string_view contents() const { return {data, size}; }
+    bool isMapped() const { return mapped; }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+    std::string fallback;
+#ifdef _WIN32
+    void* mapping = nullptr;
+#endif
+};
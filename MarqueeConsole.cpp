@@ -1,14 +1,52 @@
 #include "MarqueeConsole.h"
 #include <iostream>
 #include <functional>
+#include <cstdio>
+#include <algorithm>
 
 #ifdef _WIN32
 #include <conio.h>
 #include <windows.h>
 #else
 #include <cstdlib>
+#include <csignal>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
 #endif
 
+namespace {
+    const std::string PROMPT = "Enter command for the MARQUEE_CONSOLE: ";
+
+#ifndef _WIN32
+    volatile std::sig_atomic_t windowResized = 0;
+
+    void onWindowResize(int) {
+        windowResized = 1;
+    }
+
+    // Unbuffered, unechoed input for the lifetime of the marquee; piped stdin is left alone
+    class RawTerminal {
+    public:
+        RawTerminal() {
+            if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &saved) != 0) return;
+            termios raw = saved;
+            raw.c_lflag &= ~(ICANON | ECHO);
+            raw.c_cc[VMIN] = 0;
+            raw.c_cc[VTIME] = 0;
+            active = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+        }
+        ~RawTerminal() {
+            if (active) tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+        }
+    private:
+        termios saved{};
+        bool active = false;
+    };
+#endif
+}
+
 MarqueeConsole::MarqueeConsole() : x(0), y(HEADER_LINES), dx(1), dy(1) {
     marqueeRunning = false;
 }
@@ -17,15 +55,6 @@ MarqueeConsole::~MarqueeConsole() {
     stop();
 }
 
-void MarqueeConsole::setCursorPosition(int x, int y) {
-    #ifdef _WIN32
-    COORD pos = { static_cast<SHORT>(x), static_cast<SHORT>(y) };
-    SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), pos);
-    #else
-    printf("\033[%d;%dH", y + 1, x + 1);
-    #endif
-}
-
 void MarqueeConsole::getConsoleSize(int& width, int& height) {
     #ifdef _WIN32
     CONSOLE_SCREEN_BUFFER_INFO csbi;
@@ -33,17 +62,26 @@ void MarqueeConsole::getConsoleSize(int& width, int& height) {
     width = csbi.srWindow.Right - csbi.srWindow.Left + 1;
     height = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
     #else
-    // no terminal size detection for Linux and Mac
-    width = 80;
-    height = 24;
+    winsize size{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0) {
+        width = size.ws_col;
+        height = size.ws_row;
+    } else {
+        // Not a terminal
+        width = 80;
+        height = 24;
+    }
     #endif
 }
 
-void MarqueeConsole::displayMarqueeHeader() {
-    setCursorPosition(0, 0);
-    std::cout << "*****************************************\n";
-    std::cout << "* Displaying a marquee console!         *\n";
-    std::cout << "*****************************************\n";
+void MarqueeConsole::drawMarqueeHeader() {
+    frame.put(0, 0, "*****************************************");
+    frame.put(0, 1, "* Displaying a marquee console!         *");
+    frame.put(0, 2, "*****************************************");
+    char stats[96];
+    std::snprintf(stats, sizeof(stats), "frame %.1f us avg, %.1f us max, %zu bytes",
+                  averageFrameMicros, maxFrameMicros, lastFrameBytes);
+    frame.put(0, 3, stats);
 }
 
 void MarqueeConsole::clearScreen() {
@@ -59,143 +97,158 @@ void MarqueeConsole::displayMainHeader() {
     std::cout << "Returned to main console.\n";
 }
 
+// Draws the whole screen into the frame buffer; only cells that changed reach the terminal
+void MarqueeConsole::renderFrame() {
+    auto start = std::chrono::steady_clock::now();
+
+    #ifdef _WIN32
+    bool querySize = true;
+    #else
+    bool querySize = windowResized != 0 || frame.getWidth() == 0;
+    windowResized = 0;
+    #endif
+    if (querySize) {
+        int consoleWidth, consoleHeight;
+        getConsoleSize(consoleWidth, consoleHeight);
+        if (consoleWidth != frame.getWidth() || consoleHeight != frame.getHeight()) {
+            frame.resize(consoleWidth, consoleHeight);
+        }
+    }
+    int consoleWidth = frame.getWidth();
+    int inputLine = std::max(HEADER_LINES + 1, frame.getHeight() - RESERVED_HISTORY_LINES - 1);
+
+    if (y >= inputLine) y = inputLine - 1;
+    if (y < HEADER_LINES) y = HEADER_LINES;
+    if (x + static_cast<int>(marqueeMessage.length()) >= consoleWidth)
+        x = std::max(0, consoleWidth - static_cast<int>(marqueeMessage.length()));
+
+    frame.clear();
+    drawMarqueeHeader();
+    frame.put(x, y, marqueeMessage);
+    {
+        std::lock_guard<std::mutex> lock(consoleMutex);
+        size_t startIdx = commandHistory.size() > RESERVED_HISTORY_LINES ?
+                          commandHistory.size() - RESERVED_HISTORY_LINES : 0;
+        for (size_t i = startIdx; i < commandHistory.size(); ++i) {
+            frame.put(0, inputLine + 1 + static_cast<int>(i - startIdx), commandHistory[i]);
+        }
+        frame.put(0, inputLine, PROMPT + input);
+        frame.setCursor(static_cast<int>(PROMPT.size() + input.size()), inputLine);
+    }
+    lastFrameBytes = frame.present();
+
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    averageFrameMicros = averageFrameMicros == 0.0 ? micros : averageFrameMicros * 0.95 + micros * 0.05;
+    maxFrameMicros = std::max(maxFrameMicros, micros);
+
+    // Update position
+    x += dx;
+    y += dy;
+    if (x <= 0 || x + static_cast<int>(marqueeMessage.length()) >= consoleWidth) dx = -dx;
+    if (y <= HEADER_LINES || y >= inputLine - 1) dy = -dy;
+    if (y >= inputLine) y = inputLine - 1;
+}
+
 void MarqueeConsole::runMarqueeAnimation() {
     using clock = std::chrono::steady_clock;
-    auto lastFrame = clock::now();
     const auto frameTime = std::chrono::milliseconds(FRAME_DELAY);
+    auto nextFrame = clock::now();
 
     while (marqueeRunning) {
-        auto currentTime = clock::now();
-        auto elapsedTime = currentTime - lastFrame;
-
-        if (elapsedTime >= frameTime) {
-            {
-                std::lock_guard<std::mutex> lock(consoleMutex);
-                int consoleWidth, consoleHeight;
-                getConsoleSize(consoleWidth, consoleHeight);
-                
-                int inputLine = consoleHeight - RESERVED_HISTORY_LINES - 1;
-                if (y >= inputLine) y = inputLine - 1;
-                if (y < HEADER_LINES) y = HEADER_LINES;
-                if (x + marqueeMessage.length() >= consoleWidth) 
-                    x = std::max(0, consoleWidth - (int)marqueeMessage.length());
-                
-                // Clear animation area
-                for (int row = HEADER_LINES; row < inputLine; ++row) {
-                    setCursorPosition(0, row);
-                    std::cout << std::string(consoleWidth, ' ');
-                }
-                
-                // Draw marquee message
-                setCursorPosition(x, y);
-                std::cout << marqueeMessage << std::flush;
-            }
-
-            // Update position
-            int consoleWidth, consoleHeight;
-            getConsoleSize(consoleWidth, consoleHeight);
-            int inputLine = consoleHeight - RESERVED_HISTORY_LINES - 1;
-            
-            x += dx;
-            y += dy;
-            
-            if (x <= 0 || x + marqueeMessage.length() >= consoleWidth) dx = -dx;
-            if (y <= HEADER_LINES || y >= inputLine - 1) dy = -dy;
-            if (y >= inputLine) y = inputLine - 1;
-
-            lastFrame = currentTime;
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        renderFrame();
+        nextFrame += frameTime;
+        auto now = clock::now();
+        if (nextFrame < now) nextFrame = now; // Dropped frames are not made up
+        std::this_thread::sleep_until(nextFrame);
+    }
+}
+
+void MarqueeConsole::handleKey(char ch) {
+    // ESC [ ... final byte, e.g. arrow keys
+    if (escapeState == 1) {
+        escapeState = (ch == '[') ? 2 : 0;
+        return;
+    }
+    if (escapeState == 2) {
+        if (ch >= '@' && ch <= '~') escapeState = 0;
+        return;
+    }
+    if (ch == 27) {
+        escapeState = 1;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(consoleMutex);
+    if (ch == '\r' || ch == '\n') {
+        commandHistory.push_back("Command processed in MARQUEE_CONSOLE: " + input);
+        if (input == "exit") {
+            commandHistory.push_back("Exiting Marquee Console...");
+            marqueeRunning = false;
         }
+        input.clear();
+    } else if (ch == '\b' || ch == 127) {
+        if (!input.empty()) input.pop_back();
+    } else if (isprint(static_cast<unsigned char>(ch))) {
+        input += ch;
     }
 }
 
 void MarqueeConsole::run() {
-    clearScreen();
-    displayMarqueeHeader();
-    
-    commandHistory.clear();
+    std::cout << std::flush; // The frame buffer writes around std::cout
+    {
+        std::lock_guard<std::mutex> lock(consoleMutex);
+        commandHistory.clear();
+        input.clear();
+    }
+    escapeState = 0;
+    averageFrameMicros = maxFrameMicros = 0.0;
+    frame.invalidate();
+    #ifndef _WIN32
+    windowResized = 1;
+    struct sigaction resizeAction{}, previousAction{};
+    resizeAction.sa_handler = onWindowResize;
+    sigemptyset(&resizeAction.sa_mask);
+    sigaction(SIGWINCH, &resizeAction, &previousAction);
+    RawTerminal rawTerminal;
+    #endif
     marqueeRunning = true;
-    
+
     // Start animation thread
     marqueeThread = std::thread(&MarqueeConsole::runMarqueeAnimation, this);
-    
-    std::string input;
-    
-    #ifdef _WIN32
-    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
-    CONSOLE_CURSOR_INFO cursorInfo;
-    GetConsoleCursorInfo(console, &cursorInfo);
-    cursorInfo.bVisible = true;
-    SetConsoleCursorInfo(console, &cursorInfo);
-    #endif
 
     while (marqueeRunning) {
-        {
-            std::lock_guard<std::mutex> lock(consoleMutex);
-            int consoleWidth, consoleHeight;
-            getConsoleSize(consoleWidth, consoleHeight);
-            int inputLine = consoleHeight - RESERVED_HISTORY_LINES - 1;
-            
-            for (int row = inputLine; row < consoleHeight; ++row) {
-                setCursorPosition(0, row);
-                std::cout << std::string(consoleWidth, ' ');
-            }
-            
-            // command history
-            int startIdx = commandHistory.size() > RESERVED_HISTORY_LINES ? 
-                          commandHistory.size() - RESERVED_HISTORY_LINES : 0;
-            for (int i = startIdx; i < commandHistory.size(); ++i) {
-                int y = inputLine + 1 + (i - startIdx);
-                setCursorPosition(0, y);
-                std::cout << commandHistory[i];
-            }
-            
-            std::string prompt = "Enter command for the MARQUEE_CONSOLE: ";
-            setCursorPosition(0, inputLine);
-            std::cout << prompt << input;
-            setCursorPosition(static_cast<int>(prompt.size() + input.size()), inputLine);
-            
-            #ifdef _WIN32
-            SetConsoleCursorInfo(console, &cursorInfo);
-            #endif
-        }
-        
         #ifdef _WIN32
         if (_kbhit()) {
-            char ch = _getch();
-            if (ch == '\r') {
-                {
-                    std::lock_guard<std::mutex> lock(consoleMutex);
-                    commandHistory.push_back("Command processed in MARQUEE_CONSOLE: " + input);
-                    if (input == "exit") {
-                        commandHistory.push_back("Exiting Marquee Console...");
-                    }
-                }
-                if (input == "exit") {
-                    marqueeRunning = false;
-                }
-                input.clear();
-            } else if (ch == '\b' || ch == 127) {
-                if (!input.empty()) input.pop_back();
-            } else if (isprint(static_cast<unsigned char>(ch))) {
-                input += ch;
-            }
+            handleKey(static_cast<char>(_getch()));
+            continue;
         }
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLLING_DELAY));
         #else
-        std::getline(std::cin, input);
-        if (input == "exit") {
-            marqueeRunning = false;
+        if (!isatty(STDIN_FILENO)) {
+            // Piped input may already sit in std::cin's buffer, so keep reading it line by line
+            std::string line;
+            if (!std::getline(std::cin, line)) line = "exit";
+            for (char ch : line) handleKey(ch);
+            handleKey('\n');
+            continue;
+        }
+        pollfd pending{STDIN_FILENO, POLLIN, 0};
+        if (poll(&pending, 1, POLLING_DELAY) <= 0) continue;
+        char buffer[64];
+        ssize_t count = read(STDIN_FILENO, buffer, sizeof(buffer));
+        for (ssize_t i = 0; i < count; ++i) {
+            handleKey(buffer[i]);
         }
         #endif
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(POLLING_DELAY));
     }
-    
+
     if (marqueeThread.joinable()) {
         marqueeThread.join();
     }
-    
+    #ifndef _WIN32
+    sigaction(SIGWINCH, &previousAction, nullptr);
+    #endif
+
     if (exitCallback) {
         exitCallback();
     } else {
@@ -218,4 +271,4 @@ void MarqueeConsole::setMessage(const std::string& message) {
 
 void MarqueeConsole::setExitCallback(ExitCallback callback) {
     exitCallback = callback;
-}
\ No newline at end of file
+}
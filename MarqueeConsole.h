@@ -8,6 +8,7 @@
 #include <mutex>
 #include <chrono>
 #include <functional>
+#include "FrameBuffer.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -16,41 +17,50 @@
 
 class MarqueeConsole {
 private:
-    std::mutex consoleMutex;
+    std::mutex consoleMutex; // Guards the input line and history shared with the render thread
     std::vector<std::string> commandHistory;
+    std::string input;
     std::thread marqueeThread;
     std::atomic<bool> marqueeRunning = false;
     std::string marqueeMessage = "Hello world in marquee!";
-    
+    FrameBuffer frame;
+    int escapeState = 0; // Skips arrow keys and other escape sequences in raw input
+
+    // Render thread only
+    double averageFrameMicros = 0.0;
+    double maxFrameMicros = 0.0;
+    size_t lastFrameBytes = 0;
+
     int x = 0, y = 3;
     int dx = 1, dy = 1;
-    
+
     static constexpr int FRAME_DELAY = 16;  // 60 FPS
     static constexpr int POLLING_DELAY = 8; // 120 Hz polling
     static constexpr int RESERVED_HISTORY_LINES = 5;
-    static constexpr int HEADER_LINES = 3;
+    static constexpr int HEADER_LINES = 4;
 
     // Helper functions
-    void setCursorPosition(int x, int y);
     void getConsoleSize(int& width, int& height);
-    void displayMarqueeHeader();
+    void drawMarqueeHeader();
+    void renderFrame();
     void runMarqueeAnimation();
+    void handleKey(char ch);
     void clearScreen();
     void displayMainHeader();
-    
+
 public:
     MarqueeConsole();
     ~MarqueeConsole();
-    
+
     void run();
     void stop();
     void setMessage(const std::string& message);
-    
+
     using ExitCallback = std::function<void()>;
     void setExitCallback(ExitCallback callback);
-    
+
 private:
     ExitCallback exitCallback;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,112 @@
+#include "MemorySnapshotWriter.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+MemorySnapshotWriter::MemorySnapshotWriter(const std::string& directory)
+    : directory(directory) {}
+
+MemorySnapshotWriter::~MemorySnapshotWriter() {
+    stop();
+}
+
+void MemorySnapshotWriter::start(size_t depth, SnapshotOverflowPolicy policy, bool binary, uint32_t interval) {
+    stop();
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    queueDepth = std::max(size_t(1), depth);
+    overflowPolicy = policy;
+    binaryTrace = binary;
+    keyframeInterval = interval;
+    frontBuffer.reserve(queueDepth);
+    backBuffer.reserve(queueDepth);
+    running = true;
+    writerThread = std::thread(&MemorySnapshotWriter::writerLoop, this);
+}
+
+// Drains whatever is still queued before joining
+void MemorySnapshotWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        if (!running) return;
+        running = false;
+    }
+    bufferCv.notify_one();
+    if (writerThread.joinable()) writerThread.join();
+}
+
+void MemorySnapshotWriter::submit(MemoryStampRecord record) {
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        if (!running) return;
+        if (frontBuffer.size() >= queueDepth) {
+            if (overflowPolicy == SnapshotOverflowPolicy::DROP) {
+                dropped++;
+                return;
+            }
+            frontBuffer.back() = std::move(record);
+            coalesced++;
+            return;
+        }
+        frontBuffer.push_back(std::move(record));
+    }
+    bufferCv.notify_one();
+}
+
+void MemorySnapshotWriter::writerLoop() {
+    std::filesystem::create_directory(directory);
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(bufferMutex);
+            bufferCv.wait(lock, [this] { return !frontBuffer.empty() || !running; });
+            if (frontBuffer.empty() && !running) break;
+            std::swap(frontBuffer, backBuffer);
+        }
+        for (const auto& record : backBuffer) {
+            writeRecord(record);
+        }
+        backBuffer.clear();
+        traceWriter.flush();
+    }
+    traceWriter.close();
+}
+
+void MemorySnapshotWriter::writeRecord(const MemoryStampRecord& record) {
+    const MemorySnapshot& memory = *record.memory;
+    MemoryStampData stamp;
+    stamp.stampNumber = record.stampNumber;
+    stamp.capturedAt = record.capturedAt;
+    stamp.policy = record.policy;
+    stamp.totalMemory = memory.totalMemory;
+    stamp.externalFragmentation = memory.externalFragmentation;
+    stamp.allocationFailures = memory.allocationFailures;
+    stamp.compactionBytesMoved = memory.compactionBytesMoved;
+    stamp.compactionTimeMicros = memory.compactionTimeMicros;
+    stamp.compactionsCompleted = memory.compactionsCompleted;
+    stamp.waitingForMemory = record.waitingForMemory;
+    stamp.stampsDropped = dropped.load();
+    stamp.stampsCoalesced = coalesced.load();
+    stamp.tlb = record.tlb;
+    stamp.blocks = memory.blocks;
+
+    if (binaryTrace) {
+        if (!traceWriter.isOpen() &&
+            !traceWriter.open(directory + "/memory_stamps", memory.totalMemory, keyframeInterval)) {
+            std::cerr << "Failed to create memory trace in " << directory << std::endl;
+            return;
+        }
+        traceWriter.append(stamp);
+        written++;
+        return;
+    }
+
+    std::string filename = directory + "/" + memoryStampFileName(record.stampNumber);
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        std::cerr << "Failed to create memory snapshot file: " << filename << std::endl;
+        return;
+    }
+    writeMemoryStampText(out, stamp);
+    written++;
+}
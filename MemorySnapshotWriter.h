@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <ctime>
+#include <cstdint>
+#include "FirstFitMemoryAllocator.h"
+#include "Tlb.h"
+#include "MemoryTrace.h"
+
+// Everything a memory stamp needs, captured on the scheduler thread without any formatting or I/O
+struct MemoryStampRecord {
+    int stampNumber = 0;
+    std::time_t capturedAt = 0;
+    std::shared_ptr<const MemorySnapshot> memory;
+    PlacementPolicy policy = PlacementPolicy::FIRST_FIT;
+    size_t waitingForMemory = 0;
+    TlbStats tlb;
+};
+
+enum class SnapshotOverflowPolicy {
+    DROP,     // Discard the new record when the queue is full
+    COALESCE  // Replace the newest queued record, keeping the latest state
+};
+
+// Double-buffered stamp pipeline: submit() fills the front buffer, the writer thread swaps it
+// with the back buffer and formats/writes the records while the scheduler keeps running.
+// Stamps go to one binary trace (memory_stamps.trace/.idx) or, in text mode, one file each.
+class MemorySnapshotWriter {
+public:
+    MemorySnapshotWriter(const std::string& directory = "memory_stamps");
+    ~MemorySnapshotWriter();
+    void start(size_t queueDepth, SnapshotOverflowPolicy policy, bool binaryTrace = true, uint32_t keyframeInterval = 64);
+    void stop();
+    void submit(MemoryStampRecord record);
+    uint64_t getWritten() const { return written.load(); }
+    uint64_t getDropped() const { return dropped.load(); }
+    uint64_t getCoalesced() const { return coalesced.load(); }
+private:
+    std::string directory;
+    size_t queueDepth = 8;
+    SnapshotOverflowPolicy overflowPolicy = SnapshotOverflowPolicy::COALESCE;
+    bool binaryTrace = true;
+    uint32_t keyframeInterval = 64;
+    MemoryTraceWriter traceWriter; // Only touched by the writer thread
+    std::vector<MemoryStampRecord> frontBuffer;
+    std::vector<MemoryStampRecord> backBuffer;
+    std::mutex bufferMutex;
+    std::condition_variable bufferCv;
+    std::thread writerThread;
+    bool running = false;
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> coalesced{0};
+
+    void writerLoop();
+    void writeRecord(const MemoryStampRecord& record);
+};
@@ -0,0 +1,266 @@
+#include "MemoryTrace.h"
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr char TRACE_MAGIC[4] = {'C', 'S', 'M', 'T'};
+    constexpr uint8_t RECORD_FULL = 0;
+    constexpr uint8_t RECORD_DELTA = 1;
+
+    template <typename T>
+    void put(std::vector<char>& buf, T value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buf.insert(buf.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    bool get(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    void putBlock(std::vector<char>& buf, const AllocatedBlock& ab) {
+        put<int32_t>(buf, ab.processId);
+        put<int32_t>(buf, ab.start);
+        put<int32_t>(buf, ab.size);
+    }
+
+    bool getBlock(std::istream& in, AllocatedBlock& ab) {
+        int32_t pid, start, size;
+        if (!get(in, pid) || !get(in, start) || !get(in, size)) return false;
+        ab = AllocatedBlock(pid, start, size);
+        return true;
+    }
+}
+
+std::string memoryStampFileName(uint32_t stampNumber, int width) {
+    std::ostringstream name;
+    name << "memory_stamp_" << std::setw(width) << std::setfill('0') << stampNumber << ".txt";
+    return name.str();
+}
+
+void writeMemoryStampText(std::ostream& out, const MemoryStampData& stamp) {
+    std::tm localTime;
+    #ifdef _WIN32
+        localtime_s(&localTime, &stamp.capturedAt);
+    #else
+        localtime_r(&stamp.capturedAt, &localTime);
+    #endif
+    char buf[64];
+    std::strftime(buf, sizeof(buf), "%d/%m/%Y %I:%M:%S%p", &localTime);
+    out << "Timestamp: (" << buf << ")\n";
+    out << "Number of processes in memory: " << stamp.blocks.size() << "\n";
+    out << "Total external fragmentation in KB: " << (stamp.externalFragmentation / 1024) << "\n";
+    out << "Placement policy: " << FirstFitMemoryAllocator::policyName(stamp.policy)
+        << " | Admission stalls: " << stamp.allocationFailures << "\n";
+    out << "Compaction: " << stamp.compactionBytesMoved << " bytes moved in "
+        << stamp.compactionTimeMicros << " us (" << stamp.compactionsCompleted << " completed)\n";
+    out << "Processes waiting for memory: " << stamp.waitingForMemory << "\n";
+    out << "TLB: " << stamp.tlb.hits << " hits, " << stamp.tlb.misses << " misses ("
+        << std::fixed << std::setprecision(2) << stamp.tlb.hitRate() << "% hit rate), "
+        << stamp.tlb.walkCycles << " walk cycles\n";
+    out << "Stamps dropped: " << stamp.stampsDropped << " | coalesced: " << stamp.stampsCoalesced << "\n\n";
+
+    MemorySnapshot layout;
+    layout.blocks = stamp.blocks;
+    layout.totalMemory = stamp.totalMemory;
+    printMemorySnapshot(out, layout);
+}
+
+bool MemoryTraceWriter::open(const std::string& basePath, int totalMemory, uint32_t interval) {
+    close();
+    trace.open(basePath + ".trace", std::ios::binary | std::ios::trunc);
+    index.open(basePath + ".idx", std::ios::binary | std::ios::trunc);
+    if (!trace.is_open() || !index.is_open()) {
+        close();
+        return false;
+    }
+    keyframeInterval = std::max(uint32_t(1), interval);
+    recordsSinceKeyframe = 0;
+    lastBlocks.clear();
+
+    traceBuffer.clear();
+    traceBuffer.insert(traceBuffer.end(), TRACE_MAGIC, TRACE_MAGIC + 4);
+    put<uint32_t>(traceBuffer, VERSION);
+    put<int32_t>(traceBuffer, totalMemory);
+    put<uint32_t>(traceBuffer, keyframeInterval);
+    trace.write(traceBuffer.data(), traceBuffer.size());
+    offset = traceBuffer.size();
+    return true;
+}
+
+void MemoryTraceWriter::append(const MemoryStampData& stamp) {
+    if (!trace.is_open()) return;
+    bool keyframe = recordsSinceKeyframe == 0;
+    uint8_t kind = keyframe ? RECORD_FULL : RECORD_DELTA;
+
+    traceBuffer.clear();
+    put<uint8_t>(traceBuffer, kind);
+    put<uint32_t>(traceBuffer, stamp.stampNumber);
+    put<int64_t>(traceBuffer, static_cast<int64_t>(stamp.capturedAt));
+    put<uint8_t>(traceBuffer, static_cast<uint8_t>(stamp.policy));
+    put<int32_t>(traceBuffer, stamp.externalFragmentation);
+    put<uint64_t>(traceBuffer, stamp.allocationFailures);
+    put<uint64_t>(traceBuffer, stamp.compactionBytesMoved);
+    put<uint64_t>(traceBuffer, stamp.compactionTimeMicros);
+    put<uint64_t>(traceBuffer, stamp.compactionsCompleted);
+    put<uint64_t>(traceBuffer, stamp.waitingForMemory);
+    put<uint64_t>(traceBuffer, stamp.stampsDropped);
+    put<uint64_t>(traceBuffer, stamp.stampsCoalesced);
+    put<uint64_t>(traceBuffer, stamp.tlb.hits);
+    put<uint64_t>(traceBuffer, stamp.tlb.misses);
+    put<uint64_t>(traceBuffer, stamp.tlb.walkCycles);
+    put<uint64_t>(traceBuffer, stamp.tlb.flushes);
+
+    std::unordered_map<int, AllocatedBlock> current;
+    current.reserve(stamp.blocks.size());
+    for (const auto& ab : stamp.blocks) {
+        current.emplace(ab.processId, ab);
+    }
+
+    if (keyframe) {
+        put<uint32_t>(traceBuffer, static_cast<uint32_t>(stamp.blocks.size()));
+        for (const auto& ab : stamp.blocks) {
+            putBlock(traceBuffer, ab);
+        }
+    } else {
+        auto sameBlock = [](const AllocatedBlock& a, const AllocatedBlock& b) {
+            return a.start == b.start && a.size == b.size;
+        };
+        std::vector<int> freed;
+        for (const auto& [pid, ab] : lastBlocks) {
+            auto it = current.find(pid);
+            if (it == current.end() || !sameBlock(it->second, ab)) freed.push_back(pid);
+        }
+        std::vector<const AllocatedBlock*> allocated;
+        for (const auto& ab : stamp.blocks) {
+            auto it = lastBlocks.find(ab.processId);
+            if (it == lastBlocks.end() || !sameBlock(it->second, ab)) allocated.push_back(&ab);
+        }
+        put<uint32_t>(traceBuffer, static_cast<uint32_t>(freed.size()));
+        for (int pid : freed) {
+            put<int32_t>(traceBuffer, pid);
+        }
+        put<uint32_t>(traceBuffer, static_cast<uint32_t>(allocated.size()));
+        for (const AllocatedBlock* ab : allocated) {
+            putBlock(traceBuffer, *ab);
+        }
+    }
+
+    trace.write(traceBuffer.data(), traceBuffer.size());
+    index.write(reinterpret_cast<const char*>(&stamp.stampNumber), sizeof(uint32_t));
+    index.write(reinterpret_cast<const char*>(&offset), sizeof(uint64_t));
+    index.write(reinterpret_cast<const char*>(&kind), sizeof(uint8_t));
+    offset += traceBuffer.size();
+
+    lastBlocks = std::move(current);
+    recordsSinceKeyframe = (recordsSinceKeyframe + 1) % keyframeInterval;
+}
+
+void MemoryTraceWriter::flush() {
+    if (trace.is_open()) trace.flush();
+    if (index.is_open()) index.flush();
+}
+
+void MemoryTraceWriter::close() {
+    if (trace.is_open()) trace.close();
+    if (index.is_open()) index.close();
+}
+
+bool MemoryTraceReader::open(const std::string& basePath) {
+    trace.open(basePath + ".trace", std::ios::binary);
+    std::ifstream index(basePath + ".idx", std::ios::binary);
+    if (!trace.is_open() || !index.is_open()) return false;
+
+    char magic[4];
+    uint32_t version, interval;
+    int32_t memory;
+    if (!trace.read(magic, 4) || std::memcmp(magic, TRACE_MAGIC, 4) != 0) return false;
+    if (!get(trace, version) || version != MemoryTraceWriter::VERSION) return false;
+    if (!get(trace, memory) || !get(trace, interval)) return false;
+    totalMemory = memory;
+
+    IndexEntry entry;
+    while (get(index, entry.stampNumber) && get(index, entry.offset) && get(index, entry.kind)) {
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+uint32_t MemoryTraceReader::getFirstStamp() const {
+    return entries.empty() ? 0 : entries.front().stampNumber;
+}
+
+uint32_t MemoryTraceReader::getLastStamp() const {
+    return entries.empty() ? 0 : entries.back().stampNumber;
+}
+
+bool MemoryTraceReader::readRecord(MemoryStampData& stamp, std::unordered_map<int, AllocatedBlock>& blocks) {
+    uint8_t kind, policy;
+    int64_t capturedAt;
+    int32_t frag;
+    if (!get(trace, kind) || !get(trace, stamp.stampNumber) || !get(trace, capturedAt) ||
+        !get(trace, policy) || !get(trace, frag)) {
+        return false;
+    }
+    stamp.capturedAt = static_cast<std::time_t>(capturedAt);
+    stamp.policy = static_cast<PlacementPolicy>(policy);
+    stamp.externalFragmentation = frag;
+    stamp.totalMemory = totalMemory;
+    get(trace, stamp.allocationFailures);
+    get(trace, stamp.compactionBytesMoved);
+    get(trace, stamp.compactionTimeMicros);
+    get(trace, stamp.compactionsCompleted);
+    get(trace, stamp.waitingForMemory);
+    get(trace, stamp.stampsDropped);
+    get(trace, stamp.stampsCoalesced);
+    get(trace, stamp.tlb.hits);
+    get(trace, stamp.tlb.misses);
+    get(trace, stamp.tlb.walkCycles);
+    get(trace, stamp.tlb.flushes);
+
+    uint32_t count;
+    AllocatedBlock ab(0, 0, 0);
+    if (kind == RECORD_FULL) {
+        blocks.clear();
+        if (!get(trace, count)) return false;
+        for (uint32_t i = 0; i < count && getBlock(trace, ab); ++i) {
+            blocks.insert_or_assign(ab.processId, ab);
+        }
+    } else {
+        int32_t pid;
+        if (!get(trace, count)) return false;
+        for (uint32_t i = 0; i < count && get(trace, pid); ++i) {
+            blocks.erase(pid);
+        }
+        if (!get(trace, count)) return false;
+        for (uint32_t i = 0; i < count && getBlock(trace, ab); ++i) {
+            blocks.insert_or_assign(ab.processId, ab);
+        }
+    }
+    return static_cast<bool>(trace);
+}
+
+bool MemoryTraceReader::forEachStamp(uint32_t first, uint32_t last, const std::function<void(const MemoryStampData&)>& visit) {
+    if (entries.empty()) return false;
+    auto target = std::upper_bound(entries.begin(), entries.end(), first,
+        [](uint32_t stamp, const IndexEntry& e) { return stamp < e.stampNumber; });
+    if (target != entries.begin()) --target;
+    while (target != entries.begin() && target->kind != RECORD_FULL) --target;
+
+    trace.clear();
+    trace.seekg(static_cast<std::streamoff>(target->offset));
+    std::unordered_map<int, AllocatedBlock> blocks;
+    for (auto it = target; it != entries.end() && it->stampNumber <= last; ++it) {
+        MemoryStampData stamp;
+        if (!readRecord(stamp, blocks)) return false;
+        if (stamp.stampNumber < first) continue;
+        stamp.blocks.reserve(blocks.size());
+        for (const auto& [pid, ab] : blocks) {
+            stamp.blocks.push_back(ab);
+        }
+        visit(stamp);
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <ostream>
+#include <functional>
+#include <unordered_map>
+#include <ctime>
+#include <cstdint>
+#include "FirstFitMemoryAllocator.h"
+#include "Tlb.h"
+
+// One decoded memory stamp, as written to memory_stamp_NN.txt
+struct MemoryStampData {
+    uint32_t stampNumber = 0;
+    std::time_t capturedAt = 0;
+    PlacementPolicy policy = PlacementPolicy::FIRST_FIT;
+    int totalMemory = 0;
+    int externalFragmentation = 0;
+    uint64_t allocationFailures = 0;
+    uint64_t compactionBytesMoved = 0;
+    uint64_t compactionTimeMicros = 0;
+    uint64_t compactionsCompleted = 0;
+    uint64_t waitingForMemory = 0;
+    uint64_t stampsDropped = 0;
+    uint64_t stampsCoalesced = 0;
+    TlbStats tlb;
+    std::vector<AllocatedBlock> blocks;
+};
+
+void writeMemoryStampText(std::ostream& out, const MemoryStampData& stamp);
+std::string memoryStampFileName(uint32_t stampNumber, int width = 2);
+
+/*
+Trace layout (host byte order):
+  <name>.trace  header {magic "CSMT", version, totalMemory, keyframeInterval}
+                then records {kind, counters, payload}; kind FULL stores every block,
+                kind DELTA stores the pids freed and the blocks allocated since the last record
+  <name>.idx    one {stampNumber, offset, kind} entry per record, for random access
+A block moved by compaction shows up as freed and re-allocated in the same delta.
+*/
+class MemoryTraceWriter {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    bool open(const std::string& basePath, int totalMemory, uint32_t keyframeInterval);
+    void append(const MemoryStampData& stamp);
+    void flush();
+    void close();
+    bool isOpen() const { return trace.is_open(); }
+    uint64_t getBytesWritten() const { return offset; }
+private:
+    std::ofstream trace;
+    std::ofstream index;
+    std::vector<char> traceBuffer;
+    uint64_t offset = 0;
+    uint32_t keyframeInterval = 64;
+    uint32_t recordsSinceKeyframe = 0;
+    std::unordered_map<int, AllocatedBlock> lastBlocks;
+};
+
+class MemoryTraceReader {
+public:
+    bool open(const std::string& basePath);
+    uint32_t getFirstStamp() const;
+    uint32_t getLastStamp() const;
+    size_t getRecordCount() const { return entries.size(); }
+    // Decodes [first, last] in order, replaying deltas from the nearest keyframe at or before first
+    bool forEachStamp(uint32_t first, uint32_t last, const std::function<void(const MemoryStampData&)>& visit);
+private:
+    struct IndexEntry {
+        uint32_t stampNumber;
+        uint64_t offset;
+        uint8_t kind;
+    };
+
+    std::ifstream trace;
+    std::vector<IndexEntry> entries;
+    int totalMemory = 0;
+
+    bool readRecord(MemoryStampData& stamp, std::unordered_map<int, AllocatedBlock>& blocks);
+};
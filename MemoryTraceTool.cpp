@@ -0,0 +1,53 @@
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "MemoryTrace.h"
+
+/*
+Offline converter for the binary memory-stamp trace.
+  memtrace [trace-base]                         list the stamps in the trace
+  memtrace [trace-base] <first> <last> [outdir] write memory_stamp_NN.txt files for [first, last]
+trace-base defaults to memory_stamps/memory_stamps (the .trace and .idx files share it).
+*/
+
+int main(int argc, char* argv[]) {
+    std::string base = argc > 1 ? argv[1] : "memory_stamps/memory_stamps";
+    MemoryTraceReader reader;
+    if (!reader.open(base)) {
+        std::cerr << "Error: Could not read " << base << ".trace / " << base << ".idx\n";
+        return 1;
+    }
+
+    if (argc <= 2) {
+        std::cout << base << ": " << reader.getRecordCount() << " stamps ("
+                  << reader.getFirstStamp() << " to " << reader.getLastStamp() << ")\n";
+        return 0;
+    }
+
+    uint32_t first, last;
+    try {
+        first = static_cast<uint32_t>(std::stoul(argv[2]));
+        last = argc > 3 ? static_cast<uint32_t>(std::stoul(argv[3])) : first;
+    } catch (...) {
+        std::cerr << "Error: stamp range must be numeric\n";
+        return 1;
+    }
+    std::string outDir = argc > 4 ? argv[4] : "memory_stamps";
+    std::filesystem::create_directories(outDir);
+
+    // Pad to the widest number in the range so the files still sort past 99
+    int width = std::max<int>(2, static_cast<int>(std::to_string(last).size()));
+    size_t converted = 0;
+    bool ok = reader.forEachStamp(first, last, [&](const MemoryStampData& stamp) {
+        std::ofstream out(outDir + "/" + memoryStampFileName(stamp.stampNumber, width));
+        writeMemoryStampText(out, stamp);
+        ++converted;
+    });
+    if (!ok) {
+        std::cerr << "Error: trace is truncated or corrupt\n";
+        return 1;
+    }
+    std::cout << "Wrote " << converted << " stamps to " << outDir << "\n";
+    return 0;
+}
@@ -0,0 +1,253 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <functional>
+#include <ctime>
+#include "FirstFitMemoryAllocator.h"
+#include "FlatMemoryAllocator.h"
+#include "Process.h"
+#include "ProcessInstruction.h"
+#include "ProgramGenerator.h"
+#include "Tlb.h"
+
+/*
+Microbenchmarks for the simulator's hot paths. Results are written as JSON so runs can be diffed.
+  microbench [output.json] [--quick]
+Without an output file the JSON goes to stdout; progress lines go to stderr.
+*/
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Result {
+        std::string benchmark;
+        std::vector<std::pair<std::string, std::string>> params;
+        uint64_t operations = 0;
+        double seconds = 0.0;
+    };
+
+    std::vector<Result> results;
+    bool quick = false;
+
+    uint64_t scaled(uint64_t iterations) {
+        return quick ? std::max<uint64_t>(1, iterations / 20) : iterations;
+    }
+
+    // Times body(), which returns how many operations it performed
+    void measure(const std::string& benchmark, std::vector<std::pair<std::string, std::string>> params,
+                 const std::function<uint64_t()>& body) {
+        auto start = Clock::now();
+        uint64_t operations = body();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        results.push_back({benchmark, std::move(params), operations, seconds});
+        std::cerr << benchmark;
+        for (const auto& [key, value] : results.back().params) std::cerr << " " << key << "=" << value;
+        std::cerr << ": " << std::fixed << std::setprecision(1) << (seconds * 1e9 / std::max<uint64_t>(1, operations))
+                  << " ns/op\n";
+    }
+
+    // Fills memory to the target occupancy, then releases a random resident and admits a new one
+    template <typename Allocate, typename Release>
+    uint64_t allocatorChurn(int totalMemory, int occupancyPercent, uint64_t iterations,
+                            Allocate allocate, Release release) {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> sizeExp(8, 10); // 256..1024 bytes
+        std::vector<int> resident;
+        int nextPid = 1;
+        int used = 0;
+        while (used * 100 < totalMemory * occupancyPercent) {
+            int size = 1 << sizeExp(rng);
+            if (!allocate(nextPid, size)) break;
+            resident.push_back(nextPid++);
+            used += size;
+        }
+        uint64_t operations = 0;
+        for (uint64_t i = 0; i < iterations && !resident.empty(); ++i) {
+            size_t victim = std::uniform_int_distribution<size_t>(0, resident.size() - 1)(rng);
+            release(resident[victim]);
+            resident[victim] = resident.back();
+            resident.pop_back();
+            int pid = nextPid++;
+            if (allocate(pid, 1 << sizeExp(rng))) resident.push_back(pid);
+            operations += 2;
+        }
+        return operations;
+    }
+
+    void benchAllocators() {
+        const int totalMemory = 16384;
+        for (int occupancy : {25, 50, 75, 90}) {
+            for (PlacementPolicy policy : {PlacementPolicy::FIRST_FIT, PlacementPolicy::BEST_FIT,
+                                           PlacementPolicy::NEXT_FIT, PlacementPolicy::WORST_FIT}) {
+                measure("allocator_churn", {{"allocator", FirstFitMemoryAllocator::policyName(policy)},
+                                            {"occupancy", std::to_string(occupancy)}}, [&] {
+                    FirstFitMemoryAllocator allocator(totalMemory, 256, policy);
+                    return allocatorChurn(totalMemory, occupancy, scaled(200000),
+                        [&](int pid, int size) { return allocator.allocate(pid, size); },
+                        [&](int pid) { allocator.release(pid); });
+                });
+            }
+            measure("allocator_churn", {{"allocator", "flat"}, {"occupancy", std::to_string(occupancy)}}, [&] {
+                FlatMemoryAllocator allocator(totalMemory);
+                size_t start;
+                return allocatorChurn(totalMemory, occupancy, scaled(20000),
+                    [&](int pid, int size) { return allocator.allocate(pid, static_cast<size_t>(size), start); },
+                    [&](int pid) { allocator.deallocate(pid); });
+            });
+        }
+    }
+
+    void benchInstructions() {
+        const int count = static_cast<int>(scaled(200000));
+        Tlb tlb(16, 4, true, 20);
+        std::vector<std::pair<std::string, std::function<std::unique_ptr<IProcessInstruction>(int)>>> kinds = {
+            {"DECLARE", [](int i) { return std::make_unique<DeclareInstruction>("v" + std::to_string(i % 3 + 1), 7); }},
+            {"ADD", [](int) { return std::make_unique<AddInstruction>("v1", "v2", "v3"); }},
+            {"SUBTRACT", [](int) { return std::make_unique<SubtractInstruction>("v1", "v2", "v3"); }},
+            {"PRINT", [](int) { return std::make_unique<PrintInstruction>("Hello world from bench!"); }},
+            {"READ", [](int i) { return std::make_unique<ReadInstruction>("v1", static_cast<uint32_t>(i * 2 % 4096)); }},
+            {"WRITE", [](int i) { return std::make_unique<WriteInstruction>(static_cast<uint32_t>(i * 2 % 4096), "v2"); }},
+        };
+        for (const auto& [name, make] : kinds) {
+            Process process("bench", 1);
+            process.setMemorySize(4096);
+            process.mapMemory(0, 16, &tlb);
+            for (const char* var : {"v1", "v2", "v3"}) process.declareVariable(var, 3);
+            for (int i = 0; i < count; ++i) process.addInstruction(make(i));
+            measure("execute_instruction", {{"type", name}}, [&] {
+                uint64_t executed = 0;
+                while (!process.isComplete()) {
+                    process.executeNextInstruction();
+                    ++executed;
+                }
+                return executed;
+            });
+        }
+    }
+
+    void benchPrintInterpolation() {
+        const uint64_t iterations = scaled(200000);
+        for (const std::string message : {"Hello world from bench!", "Value of x: +v1", "+v1 + +v2 = +v3 (+missing)"}) {
+            Process process("bench", 1);
+            for (const char* var : {"v1", "v2", "v3"}) process.declareVariable(var, 42);
+            PrintInstruction print(message);
+            measure("print_interpolation", {{"message", message}}, [&] {
+                for (uint64_t i = 0; i < iterations; ++i) print.execute(process);
+                return iterations;
+            });
+        }
+    }
+
+    void benchProgramGeneration() {
+        for (uint32_t length : {100u, 1000u, 10000u}) {
+            SystemConfig config;
+            config.minInstructions = config.maxInstructions = length;
+            config.minMemPerProc = 1024;
+            config.maxMemPerProc = 4096;
+            ProgramGenerator generator(42);
+            const uint64_t programs = std::max<uint64_t>(1, scaled(2000000) / length);
+            measure("generate_program", {{"instructions", std::to_string(length)}}, [&] {
+                for (uint64_t i = 0; i < programs; ++i) {
+                    Process process("p" + std::to_string(i), static_cast<int>(i + 1));
+                    process.setMemorySize(generator.drawMemorySize(config));
+                    generator.generate(&process, config);
+                }
+                return programs;
+            });
+        }
+    }
+
+    // The scheduler's ready queue: a std::queue<int> behind one mutex, hammered from several threads
+    void benchReadyQueue() {
+        unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned threads : {1u, 2u, 4u, 8u, 16u}) {
+            if (threads > 2 * hardware) break;
+            std::queue<int> readyQueue;
+            std::mutex queueMutex;
+            const uint64_t perThread = scaled(500000) / threads;
+            measure("ready_queue", {{"threads", std::to_string(threads)}}, [&] {
+                std::vector<std::thread> workers;
+                std::atomic<bool> go{false};
+                for (unsigned t = 0; t < threads; ++t) {
+                    workers.emplace_back([&, t] {
+                        while (!go.load()) std::this_thread::yield();
+                        for (uint64_t i = 0; i < perThread; ++i) {
+                            {
+                                std::lock_guard<std::mutex> lock(queueMutex);
+                                readyQueue.push(static_cast<int>(t));
+                            }
+                            std::lock_guard<std::mutex> lock(queueMutex);
+                            if (!readyQueue.empty()) readyQueue.pop();
+                        }
+                    });
+                }
+                go.store(true);
+                for (auto& worker : workers) worker.join();
+                return perThread * threads * 2;
+            });
+        }
+    }
+
+    std::string jsonEscape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    void writeJson(std::ostream& out) {
+        out << "{\n  \"timestamp\": " << std::time(nullptr) << ",\n  \"quick\": " << (quick ? "true" : "false")
+            << ",\n  \"results\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            double nsPerOp = r.seconds * 1e9 / std::max<uint64_t>(1, r.operations);
+            out << (i ? ",\n" : "\n") << "    {\"benchmark\": \"" << r.benchmark << "\", \"params\": {";
+            for (size_t p = 0; p < r.params.size(); ++p) {
+                out << (p ? ", " : "") << "\"" << r.params[p].first << "\": \"" << jsonEscape(r.params[p].second) << "\"";
+            }
+            out << "}, \"operations\": " << r.operations << std::fixed << std::setprecision(3)
+                << ", \"seconds\": " << r.seconds << ", \"ns_per_op\": " << nsPerOp
+                << ", \"ops_per_sec\": " << (r.seconds > 0 ? r.operations / r.seconds : 0.0) << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string outputPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") quick = true;
+        else outputPath = arg;
+    }
+
+    benchAllocators();
+    benchInstructions();
+    benchPrintInterpolation();
+    benchProgramGeneration();
+    benchReadyQueue();
+
+    if (outputPath.empty()) {
+        writeJson(std::cout);
+        return 0;
+    }
+    std::ofstream out(outputPath);
+    if (!out) {
+        std::cerr << "Error: Could not write " << outputPath << "\n";
+        return 1;
+    }
+    writeJson(out);
+    std::cerr << "Wrote " << results.size() << " results to " << outputPath << "\n";
+    return 0;
+}
@@ -10,9 +10,45 @@
 #include <stack>
 #include <cstdint>
 #include <memory>
+#include <algorithm>
+#include <bitset>
+#include <fstream>
+#include <filesystem>
+#include <cctype>
+#include <deque>
 #include "ProcessInstruction.h"
+#include "Tlb.h"
+#include "ProcessLogWriter.h"
+#include "BinaryCodec.h"
 
-static std::mutex timeMutex;
+// What happens to a finished process's log lines when it is retired
+enum class LogRetention {
+    KEEP,   // Copied into the summary for screen -r
+    SPILL,  // Left in getLogFileName(); screen -r reads the file
+    DROP
+};
+
+// What reports see of a process: a consistent copy taken without stopping the worker running it
+struct ProcessStatus {
+    int core = -1;
+    size_t currentLine = 1;
+    bool complete = false;
+};
+
+// All that is kept of a finished process once it is retired; the Process itself is freed
+struct RetiredProcess {
+    std::string name;
+    std::string createdTimestamp;
+    std::string finishTimestamp;
+    int cpuUtilization = 0;
+    uint32_t dispatchCount = 0;
+    uint64_t instructions = 0; // Effective, with FOR bodies expanded
+    uint64_t cpuTicks = 0;
+    uint64_t turnaroundMillis = 0;
+    std::bitset<256> coreMask;
+    std::string logFile; // Where the log lines went when spilled; empty otherwise
+    std::string logs;    // The lines themselves when kept
+};
 
 struct ForLoopState {
     std::string varName;
@@ -26,18 +62,65 @@ private:
     std::string timestamp;
     int pid;
     int core_assigned;
-    int cpu_utilization;
+    std::atomic<int> cpu_utilization; // Share of elapsed cycles spent on a core since arrival
     
     // Instruction system stuff
     std::vector<std::unique_ptr<IProcessInstruction>> instructionList;
+    // Set instead of instructionList when the program came from a shared, cached file
+    std::shared_ptr<const CompiledProgram> sharedProgram;
     size_t instructionCounter;
     bool execution_complete;
     
     // Process state management
     std::unordered_map<std::string, uint16_t> variables;
-    std::vector<std::pair<std::string, std::string>> logs;
+    // Only the newest lines stay in memory when a log writer streams the rest to getLogFileName()
+    std::deque<std::string> logTail;
+    size_t logLineCount = 0;
+    ProcessLogWriter* logWriter = nullptr;
     int sleepTicks = 0;
     std::stack<ForLoopState> forStack;
+    int memorySize = 0; // Bytes requested from the memory allocator
+
+    // Address translation; pages are mem-per-frame bytes and frames follow the allocated block
+    std::unordered_map<uint32_t, uint16_t> memoryContents;
+    std::vector<uint32_t> pageTable;
+    int pageSize = 0;
+    int memoryBase = -1;
+    Tlb* tlb = nullptr;
+
+    // Copied into a RetiredProcess when the process is retired
+    mutable std::mutex logMutex;
+    std::chrono::steady_clock::time_point createdAt;
+    std::chrono::steady_clock::time_point completedAt;
+    size_t totalInstructions = 0;
+    size_t effectiveInstructions = 0;
+    std::bitset<256> coreHistory;
+    uint32_t dispatchCount = 0;
+    // Scheduling latency, stamped by the scheduler under its queue lock
+    std::chrono::steady_clock::time_point arrivedAt{};
+    std::chrono::steady_clock::time_point readySince{};
+    std::chrono::steady_clock::time_point firstDispatchAt{};
+    std::chrono::microseconds totalWait{0};
+    uint64_t arrivalTick = 0;
+    std::atomic<uint64_t> cpuTicks{0};
+
+    // Seqlock over the published status: odd while a writer is mid-update. Workers and the
+    // scheduler can both publish (a preempt races the last instruction), so writers claim the
+    // odd state with a CAS; readers retry until they see the same even sequence on both sides.
+    mutable std::atomic<uint32_t> statusSequence{0};
+    std::atomic<int> statusCore{-1};
+    std::atomic<size_t> statusLine{1};
+    std::atomic<bool> statusComplete{false};
+
+    template <typename Update>
+    void publishStatus(Update update) {
+        uint32_t sequence = statusSequence.load(std::memory_order_relaxed);
+        do {
+            while (sequence & 1) sequence = statusSequence.load(std::memory_order_relaxed);
+        } while (!statusSequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire));
+        update();
+        statusSequence.store(sequence + 2, std::memory_order_release);
+    }
 
 public:
     int getSleepTicks() const { return sleepTicks; }
@@ -50,8 +133,7 @@ public:
     }
 private:
     
-    std::string getCurrentTimestamp() {
-        std::lock_guard<std::mutex> lock(timeMutex);
+    static std::string getCurrentTimestamp() {
         auto now = std::chrono::system_clock::now();
         auto now_time_t = std::chrono::system_clock::to_time_t(now);
         std::tm local_tm;
@@ -65,6 +147,18 @@ private:
         return oss.str();
     }
 
+    // Caller holds logMutex
+    std::string logsLocked() const {
+        std::string result;
+        if (logLineCount > logTail.size()) {
+            result += "... " + std::to_string(logLineCount - logTail.size()) + " earlier lines in " + getLogFileName() + "\n";
+        }
+        for (const auto& line : logTail) {
+            result += line + "\n";
+        }
+        return result;
+    }
+
 public:
     Process() = delete;
 
@@ -74,7 +168,8 @@ public:
           core_assigned(core),
           cpu_utilization(0),
           instructionCounter(0),
-          execution_complete(false) {
+          execution_complete(false),
+          createdAt(std::chrono::steady_clock::now()) {
         timestamp = getCurrentTimestamp();
     }
 
@@ -85,21 +180,28 @@ public:
             --sleepTicks;
             return "SLEEPING";
         }
-        if (instructionCounter >= instructionList.size()) {
-            execution_complete = true;
+        const auto& instructions = program();
+        if (instructionCounter >= instructions.size()) {
+            markComplete();
             return "Finished!";
         }
+        bool printed = instructions[instructionCounter]->getType() == InstructionType::PRINT;
         executeCurrentInstruction();
         moveToNextLine();
-        if (instructionCounter >= instructionList.size()) {
-            execution_complete = true;
+        // Last touch of the program: once complete, the scheduler may retire it
+        if (instructionCounter >= instructions.size()) {
+            markComplete();
+        } else {
+            size_t line = instructionCounter + 1;
+            publishStatus([&] { statusLine.store(line, std::memory_order_relaxed); });
         }
-        return instructionList[instructionCounter - 1]->getType() == InstructionType::PRINT ? "PRINT" : "EXECUTED";
+        return printed ? "PRINT" : "EXECUTED";
     }
     
     void executeCurrentInstruction() {
-        if (instructionCounter < instructionList.size()) {
-            instructionList[instructionCounter]->execute(*this);
+        const auto& instructions = program();
+        if (instructionCounter < instructions.size()) {
+            instructions[instructionCounter]->execute(*this);
         }
     }
     
@@ -108,7 +210,17 @@ public:
     }
 
     void addInstruction(std::unique_ptr<IProcessInstruction> instruction) {
+        effectiveInstructions += countExpanded(instruction.get());
         instructionList.push_back(std::move(instruction));
+        totalInstructions = instructionList.size();
+    }
+
+    // Runs a shared program in place of any added instructions
+    void setProgram(std::shared_ptr<const CompiledProgram> compiled) {
+        std::vector<std::unique_ptr<IProcessInstruction>>().swap(instructionList);
+        totalInstructions = compiled->instructions.size();
+        effectiveInstructions = compiled->effectiveInstructions;
+        sharedProgram = std::move(compiled);
     }
 
     void declareVariable(const std::string& var, uint16_t value = 0) {
@@ -153,14 +265,311 @@ public:
         return forStack.top();
     }
 
+    // Rebuilds the page table only when the block moved or the page size changed
+    // True if the page table was rebuilt, so cached translations of this pid are stale
+    bool mapMemory(int base, int pageBytes, Tlb* coreTlb) {
+        tlb = coreTlb;
+        if (base == memoryBase && pageBytes == pageSize) return false;
+        memoryBase = base;
+        pageSize = std::max(1, pageBytes);
+        size_t pages = (memorySize + pageSize - 1) / pageSize;
+        uint32_t baseFrame = std::max(0, base) / pageSize;
+        pageTable.resize(pages);
+        for (size_t vpn = 0; vpn < pages; ++vpn) {
+            pageTable[vpn] = baseFrame + static_cast<uint32_t>(vpn);
+        }
+        return true;
+    }
+
+    uint32_t translate(uint32_t address) {
+        uint32_t vpn = address / std::max(1, pageSize);
+        uint32_t offset = address % std::max(1, pageSize);
+        uint32_t frame = tlb ? tlb->translate(pid, vpn, pageTable)
+                             : (vpn < pageTable.size() ? pageTable[vpn] : 0);
+        return frame * pageSize + offset;
+    }
+
+    // Contents are keyed by virtual address, so compaction never has to copy them
+    uint16_t readMemory(uint32_t address) {
+        if (address + 1 >= static_cast<uint32_t>(memorySize)) {
+            addToLog("Access violation reading address " + std::to_string(address));
+            return 0;
+        }
+        translate(address);
+        auto it = memoryContents.find(address);
+        return it != memoryContents.end() ? it->second : 0;
+    }
+
+    void writeMemory(uint32_t address, uint16_t value) {
+        if (address + 1 >= static_cast<uint32_t>(memorySize)) {
+            addToLog("Access violation writing address " + std::to_string(address));
+            return;
+        }
+        translate(address);
+        memoryContents[address] = value;
+    }
+
     void setSleepTicks(int ticks) {
         sleepTicks = std::max(0, ticks);
     }
     
     void setComplete(bool complete) {
-        execution_complete = complete;
+        if (complete) {
+            markComplete();
+        } else {
+            execution_complete = false;
+        }
     }
-    
+
+    void markComplete() {
+        if (!execution_complete) completedAt = std::chrono::steady_clock::now();
+        execution_complete = true;
+        size_t line = instructionCounter + 1;
+        publishStatus([&] {
+            statusLine.store(line, std::memory_order_relaxed);
+            statusComplete.store(true, std::memory_order_relaxed);
+        });
+    }
+
+    ProcessStatus getStatus() const {
+        ProcessStatus status;
+        while (true) {
+            uint32_t before = statusSequence.load(std::memory_order_acquire);
+            if (before & 1) continue;
+            status.core = statusCore.load(std::memory_order_relaxed);
+            status.currentLine = statusLine.load(std::memory_order_relaxed);
+            status.complete = statusComplete.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (statusSequence.load(std::memory_order_relaxed) == before) return status;
+        }
+    }
+
+    void markArrived(std::chrono::steady_clock::time_point now, uint64_t tick) {
+        if (arrivedAt == std::chrono::steady_clock::time_point{}) {
+            arrivedAt = now;
+            arrivalTick = tick;
+        }
+    }
+
+    void markReady(std::chrono::steady_clock::time_point now, uint64_t tick) {
+        markArrived(now, tick);
+        readySince = now;
+    }
+
+    // Called by the worker for each tick it spends executing this process. The global tick
+    // advances once per core per cycle, so it is divided by the core count to get elapsed cycles.
+    void addCpuTick(uint64_t tick, int numCores) {
+        uint64_t executed = cpuTicks.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint64_t elapsed = std::max<uint64_t>(1, (tick - arrivalTick) / std::max(1, numCores));
+        cpu_utilization = static_cast<int>(std::min<uint64_t>(100, executed * 100 / elapsed));
+    }
+    uint64_t getCpuTicks() const { return cpuTicks.load(std::memory_order_relaxed); }
+
+    // Returns how long this dispatch waited in the ready queue
+    std::chrono::microseconds markDispatched(std::chrono::steady_clock::time_point now) {
+        if (firstDispatchAt == std::chrono::steady_clock::time_point{}) firstDispatchAt = now;
+        auto wait = std::chrono::duration_cast<std::chrono::microseconds>(now - readySince);
+        totalWait += wait;
+        return wait;
+    }
+
+    // The summary that replaces a finished process in the table, with its logs spilled, copied
+    // or dropped as retention says. The caller frees the process afterwards.
+    RetiredProcess retire(LogRetention retention) const {
+        RetiredProcess summary;
+        summary.name = processName;
+        summary.createdTimestamp = timestamp;
+        summary.finishTimestamp = getCurrentTimestamp();
+        summary.cpuUtilization = cpu_utilization;
+        summary.dispatchCount = dispatchCount;
+        summary.instructions = effectiveInstructions;
+        summary.cpuTicks = cpuTicks.load(std::memory_order_relaxed);
+        summary.turnaroundMillis = static_cast<uint64_t>(std::max<long long>(0, getTurnaroundMillis()));
+        summary.coreMask = coreHistory;
+
+        std::lock_guard<std::mutex> lock(logMutex);
+        if (retention == LogRetention::SPILL && !logTail.empty()) {
+            bool spilled;
+            if (logWriter && logWriter->isRunning()) {
+                spilled = true; // Already streamed
+            } else {
+                std::error_code ignored;
+                std::filesystem::create_directory(ProcessLogWriter::LOG_DIRECTORY, ignored);
+                std::ofstream logFile(getLogFileName());
+                for (const auto& line : logTail) {
+                    logFile << line << "\n";
+                }
+                spilled = static_cast<bool>(logFile);
+            }
+            if (spilled) {
+                summary.logFile = getLogFileName();
+            } else {
+                retention = LogRetention::KEEP; // Keep them rather than lose them
+            }
+        }
+        if (retention == LogRetention::KEEP) {
+            summary.logs = logsLocked();
+        }
+        return summary;
+    }
+
+    // Checkpoint form of the process. The page table and TLB are left out since the next
+    // dispatch rebuilds them; steady-clock times are stored as ages, so latencies carry over.
+    void saveState(BinaryWriter& out, std::chrono::steady_clock::time_point now) const {
+        auto putTime = [&](std::chrono::steady_clock::time_point time) {
+            if (time == std::chrono::steady_clock::time_point{}) {
+                out.putVarint(0);
+                return;
+            }
+            auto age = std::chrono::duration_cast<std::chrono::microseconds>(now - time).count();
+            out.putVarint(1 + static_cast<uint64_t>(std::max<int64_t>(0, age)));
+        };
+        out.putBytes(timestamp);
+        out.putVarint(static_cast<uint64_t>(core_assigned + 1));
+        out.putVarint(static_cast<uint64_t>(cpu_utilization.load()));
+        out.putByte(execution_complete ? 1 : 0);
+        out.putVarint(instructionCounter);
+        out.putVarint(totalInstructions);
+        out.putVarint(effectiveInstructions);
+        out.putVarint(program().size());
+        for (const auto& instruction : program()) {
+            writeInstruction(out, *instruction);
+        }
+        out.putVarint(variables.size());
+        for (const auto& [name, value] : variables) {
+            out.putString(name);
+            out.putVarint(value);
+        }
+        out.putVarint(static_cast<uint64_t>(sleepTicks));
+        std::stack<ForLoopState> loops = forStack;
+        std::vector<ForLoopState> loopList;
+        for (; !loops.empty(); loops.pop()) loopList.push_back(loops.top());
+        out.putVarint(loopList.size());
+        for (auto it = loopList.rbegin(); it != loopList.rend(); ++it) {
+            out.putString(it->varName);
+            out.putVarint(it->endValue);
+            out.putVarint(it->instructionIndex);
+        }
+        out.putVarint(static_cast<uint64_t>(memorySize));
+        out.putVarint(memoryContents.size());
+        for (const auto& [address, value] : memoryContents) {
+            out.putVarint(address);
+            out.putVarint(value);
+        }
+        for (size_t word = 0; word < coreHistory.size() / 64; ++word) {
+            uint64_t bits = 0;
+            for (size_t bit = 0; bit < 64; ++bit) {
+                if (coreHistory.test(word * 64 + bit)) bits |= uint64_t(1) << bit;
+            }
+            out.putFixed64(bits);
+        }
+        out.putVarint(dispatchCount);
+        out.putVarint(cpuTicks.load(std::memory_order_relaxed));
+        out.putVarint(arrivalTick);
+        putTime(createdAt);
+        putTime(completedAt);
+        putTime(arrivedAt);
+        putTime(readySince);
+        putTime(firstDispatchAt);
+        out.putVarint(static_cast<uint64_t>(totalWait.count()));
+
+        std::lock_guard<std::mutex> lock(logMutex);
+        out.putVarint(logLineCount);
+        out.putVarint(logTail.size());
+        for (const auto& line : logTail) {
+            out.putBytes(line);
+        }
+    }
+
+    // Inverse of saveState on a freshly created process; false if the input is malformed
+    bool restoreState(BinaryReader& in, std::chrono::steady_clock::time_point now) {
+        auto getTime = [&](std::chrono::steady_clock::time_point& time) {
+            uint64_t encoded;
+            if (!in.getVarint(encoded)) return false;
+            time = encoded == 0 ? std::chrono::steady_clock::time_point{}
+                                : now - std::chrono::microseconds(encoded - 1);
+            return true;
+        };
+        uint64_t core, utilization, count, value;
+        uint8_t flags;
+        if (!in.getBytes(timestamp) || !in.getVarint(core) ||
+            !in.getVarint(utilization) || !in.getByte(flags) || !in.getVarint(instructionCounter) ||
+            !in.getVarint(totalInstructions) || !in.getVarint(effectiveInstructions) || !in.getVarint(count)) {
+            return false;
+        }
+        core_assigned = static_cast<int>(core) - 1;
+        cpu_utilization = static_cast<int>(utilization);
+        execution_complete = flags & 1;
+        sharedProgram.reset();
+        instructionList.clear();
+        instructionList.reserve(std::min<uint64_t>(count, in.remaining()));
+        for (uint64_t i = 0; i < count; ++i) {
+            auto instruction = readInstruction(in);
+            if (!instruction) return false;
+            instructionList.push_back(std::move(instruction));
+        }
+
+        if (!in.getVarint(count)) return false;
+        variables.clear();
+        for (uint64_t i = 0; i < count; ++i) {
+            std::string name;
+            if (!in.getString(name) || !in.getVarint(value)) return false;
+            variables[name] = static_cast<uint16_t>(value);
+        }
+        if (!in.getVarint(sleepTicks) || !in.getVarint(count)) return false;
+        forStack = {};
+        for (uint64_t i = 0; i < count; ++i) {
+            ForLoopState loop;
+            if (!in.getString(loop.varName) || !in.getVarint(loop.endValue) || !in.getVarint(loop.instructionIndex)) return false;
+            forStack.push(std::move(loop));
+        }
+        if (!in.getVarint(memorySize) || !in.getVarint(count)) return false;
+        memoryContents.clear();
+        memoryContents.reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+            uint32_t address;
+            if (!in.getVarint(address) || !in.getVarint(value)) return false;
+            memoryContents[address] = static_cast<uint16_t>(value);
+        }
+        coreHistory.reset();
+        for (size_t word = 0; word < coreHistory.size() / 64; ++word) {
+            uint64_t bits;
+            if (!in.getFixed64(bits)) return false;
+            for (size_t bit = 0; bit < 64; ++bit) {
+                if (bits & (uint64_t(1) << bit)) coreHistory.set(word * 64 + bit);
+            }
+        }
+        uint64_t ticks, waitMicros;
+        if (!in.getVarint(dispatchCount) || !in.getVarint(ticks) || !in.getVarint(arrivalTick) ||
+            !getTime(createdAt) || !getTime(completedAt) || !getTime(arrivedAt) || !getTime(readySince) ||
+            !getTime(firstDispatchAt) || !in.getVarint(waitMicros)) {
+            return false;
+        }
+        cpuTicks.store(ticks, std::memory_order_relaxed);
+        totalWait = std::chrono::microseconds(waitMicros);
+        memoryBase = -1; // Forces the next mapMemory to rebuild the page table
+        tlb = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            if (!in.getVarint(logLineCount) || !in.getVarint(count)) return false;
+            logTail.clear();
+            for (uint64_t i = 0; i < count; ++i) {
+                std::string line;
+                if (!in.getBytes(line)) return false;
+                logTail.push_back(std::move(line));
+            }
+        }
+
+        size_t line = instructionCounter + 1;
+        publishStatus([&] {
+            statusCore.store(core_assigned, std::memory_order_relaxed);
+            statusLine.store(line, std::memory_order_relaxed);
+            statusComplete.store(execution_complete, std::memory_order_relaxed);
+        });
+        return true;
+    }
+
     void setInstructionIndex(size_t index) {
         instructionCounter = index;
     }
@@ -169,7 +578,13 @@ public:
     void addToLog(const std::string& message) {
         std::string currentTime = getCurrentTimestamp();
         std::string logEntry = "(" + currentTime + ") Core: " + std::to_string(core_assigned) + " \"" + message + "\"";
-        logs.emplace_back(currentTime, logEntry);
+        std::lock_guard<std::mutex> lock(logMutex);
+        ++logLineCount;
+        if (logWriter && logWriter->isRunning()) {
+            logWriter->append(getLogFileName(), logEntry);
+            if (logTail.size() >= logWriter->getTailLines()) logTail.pop_front();
+        }
+        logTail.push_back(std::move(logEntry));
     }
 
     // Display methods
@@ -182,9 +597,9 @@ public:
         std::cout << "Process Name: " << processName << " (PID: " << pid << ")\n";
         std::cout << "Core Assigned: " << std::to_string(core_assigned) << "\n";
         std::cout << "CPU Utilization: " << cpu_utilization << "%\n";
-        std::cout << "Current Instruction: " << instructionCounter + 1 << " / " << instructionList.size() << "\n";
-        if (instructionCounter < instructionList.size()) {
-            std::cout << "Executing instruction type: " << static_cast<int>(instructionList[instructionCounter]->getType()) << "\n";
+        std::cout << "Current Instruction: " << instructionCounter + 1 << " / " << totalInstructions << "\n";
+        if (instructionCounter < program().size()) {
+            std::cout << "Executing instruction type: " << static_cast<int>(program()[instructionCounter]->getType()) << "\n";
         }
         std::cout << "Created: " << timestamp << "\n";
     }
@@ -202,28 +617,59 @@ public:
     int getCPUUtilization() const { return cpu_utilization; }
     std::string getTimestamp() const { return timestamp; }
     size_t getCurrentInstructionNumber() const { return instructionCounter + 1; }
-    size_t getTotalInstructions() const { return instructionList.size(); }
+    size_t getTotalInstructions() const { return totalInstructions; }
+    const std::vector<std::unique_ptr<IProcessInstruction>>& getInstructions() const { return program(); }
+    bool hasSharedProgram() const { return sharedProgram != nullptr; }
     bool isComplete() const { return execution_complete; }
-    std::string getLogFileName() const { return processName + ".txt"; }
+    uint32_t getDispatchCount() const { return dispatchCount; }
+    const std::bitset<256>& getCoreHistory() const { return coreHistory; }
+    bool hasBeenDispatched() const { return firstDispatchAt != std::chrono::steady_clock::time_point{}; }
+    std::chrono::microseconds getResponseTime() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(firstDispatchAt - arrivedAt);
+    }
+    std::chrono::microseconds getTurnaroundTime() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(completedAt - arrivedAt);
+    }
+    std::chrono::microseconds getTotalWait() const { return totalWait; }
+    long long getTurnaroundMillis() const {
+        if (!execution_complete) return 0;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(completedAt - createdAt).count();
+    }
+    // Names may repeat or hold path characters, so the pid keeps the file unique and inside logs/
+    std::string getLogFileName() const {
+        std::string safeName = processName;
+        for (char& c : safeName) {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') c = '_';
+        }
+        return std::string(ProcessLogWriter::LOG_DIRECTORY) + "/" + std::to_string(pid) + "-" + safeName + ".txt";
+    }
 
     std::string getLogs() const {
-        std::string result;
-        for (const auto& log : logs) {
-            result += log.second + "\n";
-        }
-        return result;
+        std::lock_guard<std::mutex> lock(logMutex);
+        return logsLocked();
     }
 
     // Setters
-    void setCore(int core) { core_assigned = core; }
+    void setCore(int core) {
+        core_assigned = core;
+        publishStatus([&] { statusCore.store(core, std::memory_order_relaxed); });
+        if (core >= 0) {
+            coreHistory.set(static_cast<size_t>(core) % coreHistory.size());
+            ++dispatchCount;
+        }
+    }
     void setCPUUtilization(int util) { cpu_utilization = util; }
+    void setLogWriter(ProcessLogWriter* writer) { logWriter = writer; }
+    void setMemorySize(int size) { memorySize = size; }
+    int getMemorySize() const { return memorySize; }
 
+    // Cached as instructions are added, so it survives retirement
     size_t countEffectiveInstructions() const {
-        size_t total = 0;
-        for (const auto& instr : instructionList) {
-            total += countExpanded(instr.get());
-        }
-        return total;
+        return effectiveInstructions;
+    }
+
+    const std::vector<std::unique_ptr<IProcessInstruction>>& program() const {
+        return sharedProgram ? sharedProgram->instructions : instructionList;
     }
 
     size_t countExpanded(const IProcessInstruction* instr) const {
@@ -1,12 +1,13 @@
 #include "ProcessInstruction.h"
 #include "Process.h"
+#include "BinaryCodec.h"
 #include <vector>
 #include <regex>
+#include <algorithm>
 
-// Thread-local variables for FOR
-thread_local int for_nesting_level = 0;
-thread_local int for_current_rep[4] = {0,0,0,0};
-thread_local int for_total_rep[4] = {0,0,0,0};
+namespace {
+    constexpr int MAX_FOR_DEPTH = 8;
+}
 
 void AddInstruction::execute(Process& process) {
     uint16_t val2 = process.getVariableValue(var2);
@@ -28,18 +29,21 @@ void SleepInstruction::execute(Process& process) {
 }
 
 void ForInstruction::execute(Process& process) {
-    if (++for_nesting_level > 3) {
-        --for_nesting_level;
-        return;
-    }
-    for_total_rep[for_nesting_level] = repeats;
+    executeNested(process, 1);
+}
+
+// Nesting depth is passed down the recursion rather than kept in thread-local counters
+void ForInstruction::executeNested(Process& process, int depth) {
+    if (depth > 3) return;
     for (int i = 0; i < repeats; ++i) {
-        for_current_rep[for_nesting_level] = i + 1;
         for (auto& instr : instructions) {
-            instr->execute(process);
+            if (instr->getType() == InstructionType::FOR) {
+                static_cast<ForInstruction&>(*instr).executeNested(process, depth + 1);
+            } else {
+                instr->execute(process);
+            }
         }
     }
-    --for_nesting_level;
 }
 
 void PrintInstruction::execute(Process& process) {
@@ -82,4 +86,107 @@ void PrintInstruction::execute(Process& process) {
 
 void DeclareInstruction::execute(Process& process) {
     process.declareVariable(varName, value);
-}
\ No newline at end of file
+}
+
+void ReadInstruction::execute(Process& process) {
+    process.setVariableValue(varName, process.readMemory(address));
+}
+
+void WriteInstruction::execute(Process& process) {
+    process.writeMemory(address, process.getVariableValue(value));
+}
+
+void writeInstruction(BinaryWriter& out, const IProcessInstruction& instruction) {
+    out.putByte(static_cast<uint8_t>(instruction.getType()));
+    switch (instruction.getType()) {
+        case InstructionType::ADD: {
+            const auto& add = static_cast<const AddInstruction&>(instruction);
+            out.putString(add.getVar1());
+            out.putString(add.getVar2());
+            out.putString(add.getVar3());
+            break;
+        }
+        case InstructionType::SUBTRACT: {
+            const auto& sub = static_cast<const SubtractInstruction&>(instruction);
+            out.putString(sub.getVar1());
+            out.putString(sub.getVar2());
+            out.putString(sub.getVar3());
+            break;
+        }
+        case InstructionType::SLEEP:
+            out.putVarint(static_cast<uint64_t>(std::max(0, static_cast<const SleepInstruction&>(instruction).getTicks())));
+            break;
+        case InstructionType::PRINT:
+            out.putString(static_cast<const PrintInstruction&>(instruction).getMessage());
+            break;
+        case InstructionType::DECLARE: {
+            const auto& declare = static_cast<const DeclareInstruction&>(instruction);
+            out.putString(declare.getVarName());
+            out.putVarint(declare.getValue());
+            break;
+        }
+        case InstructionType::READ: {
+            const auto& read = static_cast<const ReadInstruction&>(instruction);
+            out.putString(read.getVarName());
+            out.putVarint(read.getAddress());
+            break;
+        }
+        case InstructionType::WRITE: {
+            const auto& write = static_cast<const WriteInstruction&>(instruction);
+            out.putVarint(write.getAddress());
+            out.putString(write.getValue());
+            break;
+        }
+        case InstructionType::FOR: {
+            const auto& loop = static_cast<const ForInstruction&>(instruction);
+            out.putVarint(static_cast<uint64_t>(std::max(0, loop.getRepeatCount())));
+            out.putVarint(loop.getBody().size());
+            for (const auto& nested : loop.getBody()) {
+                writeInstruction(out, *nested);
+            }
+            break;
+        }
+    }
+}
+
+std::unique_ptr<IProcessInstruction> readInstruction(BinaryReader& in, int depth) {
+    uint8_t type;
+    if (!in.getByte(type) || depth > MAX_FOR_DEPTH) return nullptr;
+    std::string a, b, c;
+    uint64_t x, y;
+    switch (static_cast<InstructionType>(type)) {
+        case InstructionType::ADD:
+            if (in.getString(a) && in.getString(b) && in.getString(c)) return std::make_unique<AddInstruction>(a, b, c);
+            break;
+        case InstructionType::SUBTRACT:
+            if (in.getString(a) && in.getString(b) && in.getString(c)) return std::make_unique<SubtractInstruction>(a, b, c);
+            break;
+        case InstructionType::SLEEP:
+            if (in.getVarint(x)) return std::make_unique<SleepInstruction>(static_cast<int>(x));
+            break;
+        case InstructionType::PRINT:
+            if (in.getString(a)) return std::make_unique<PrintInstruction>(a);
+            break;
+        case InstructionType::DECLARE:
+            if (in.getString(a) && in.getVarint(x)) return std::make_unique<DeclareInstruction>(a, static_cast<uint16_t>(x));
+            break;
+        case InstructionType::READ:
+            if (in.getString(a) && in.getVarint(x)) return std::make_unique<ReadInstruction>(a, static_cast<uint32_t>(x));
+            break;
+        case InstructionType::WRITE:
+            if (in.getVarint(x) && in.getString(a)) return std::make_unique<WriteInstruction>(static_cast<uint32_t>(x), a);
+            break;
+        case InstructionType::FOR: {
+            if (!in.getVarint(x) || !in.getVarint(y)) break;
+            std::vector<std::unique_ptr<IProcessInstruction>> body;
+            body.reserve(std::min<uint64_t>(y, in.remaining()));
+            for (uint64_t i = 0; i < y; ++i) {
+                auto nested = readInstruction(in, depth + 1);
+                if (!nested) return nullptr;
+                body.push_back(std::move(nested));
+            }
+            return std::make_unique<ForInstruction>(std::move(body), static_cast<int>(x));
+        }
+    }
+    return nullptr;
+}
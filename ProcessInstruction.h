@@ -1,8 +1,12 @@
 #pragma once
 #include <cstring>
+#include <cstdint>
+#include <string>
 #include <memory>
 #include <vector>
 class Process;
+class BinaryWriter;
+class BinaryReader;
 
 enum class InstructionType {
     ADD,
@@ -10,7 +14,9 @@ enum class InstructionType {
     DECLARE,
     SUBTRACT,
     SLEEP,
-    FOR
+    FOR,
+    READ,
+    WRITE
 };
 
 class IProcessInstruction {
@@ -28,6 +34,9 @@ public:
         : var1(v1), var2(v2), var3(v3) {}
     void execute(class Process& process) override;
     InstructionType getType() const override { return InstructionType::ADD; }
+    const std::string& getVar1() const { return var1; }
+    const std::string& getVar2() const { return var2; }
+    const std::string& getVar3() const { return var3; }
 };
 
 // SUBTRACT instruction: var1 = var2/value - var3/value
@@ -38,6 +47,9 @@ public:
         : var1(v1), var2(v2), var3(v3) {}
     void execute(class Process& process) override;
     InstructionType getType() const override { return InstructionType::SUBTRACT; }
+    const std::string& getVar1() const { return var1; }
+    const std::string& getVar2() const { return var2; }
+    const std::string& getVar3() const { return var3; }
 };
 
 // SLEEP instruction
@@ -47,12 +59,14 @@ public:
     SleepInstruction(int t) : ticks(t) {}
     void execute(class Process& process) override;
     InstructionType getType() const override { return InstructionType::SLEEP; }
+    int getTicks() const { return ticks; }
 };
 
 // FOR instruction (can be nested up to 3 times)
 class ForInstruction : public IProcessInstruction {
     std::vector<std::unique_ptr<IProcessInstruction>> instructions;
     int repeats;
+    void executeNested(class Process& process, int depth);
 public:
     ForInstruction(std::vector<std::unique_ptr<IProcessInstruction>> instrs, int reps)
         : instructions(std::move(instrs)), repeats(reps) {}
@@ -80,4 +94,42 @@ public:
     DeclareInstruction(const std::string& var, uint16_t val) : varName(var), value(val) {}
     InstructionType getType() const override { return InstructionType::DECLARE; }
     void execute(class Process& process) override;
-};
\ No newline at end of file
+    const std::string& getVarName() const { return varName; }
+    uint16_t getValue() const { return value; }
+};
+
+// READ instruction: var = uint16 at address in the process's memory
+class ReadInstruction : public IProcessInstruction {
+    std::string varName;
+    uint32_t address;
+public:
+    ReadInstruction(const std::string& var, uint32_t addr) : varName(var), address(addr) {}
+    InstructionType getType() const override { return InstructionType::READ; }
+    void execute(class Process& process) override;
+    const std::string& getVarName() const { return varName; }
+    uint32_t getAddress() const { return address; }
+};
+
+// WRITE instruction: uint16 at address = var/value
+class WriteInstruction : public IProcessInstruction {
+    uint32_t address;
+    std::string value;
+public:
+    WriteInstruction(uint32_t addr, const std::string& val) : address(addr), value(val) {}
+    InstructionType getType() const override { return InstructionType::WRITE; }
+    void execute(class Process& process) override;
+    uint32_t getAddress() const { return address; }
+    const std::string& getValue() const { return value; }
+};
+
+// A program that any number of processes can run at once; instructions keep no per-process
+// state, so one parsed copy is enough
+struct CompiledProgram {
+    std::vector<std::unique_ptr<IProcessInstruction>> instructions;
+    size_t effectiveInstructions = 0; // FOR bodies counted once per repeat
+};
+
+// Binary form used by workload files and checkpoints: a type byte, then the operands, with a
+// FOR's repeat count and body written recursively. readInstruction returns null on bad input.
+void writeInstruction(BinaryWriter& out, const IProcessInstruction& instruction);
+std::unique_ptr<IProcessInstruction> readInstruction(BinaryReader& in, int depth = 0);
@@ -0,0 +1,189 @@
+#include "ProcessLogWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#ifdef _WIN32
+    #include <fstream>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/uio.h>
+    #include <climits>
+#endif
+
+ProcessLogWriter::~ProcessLogWriter() {
+    stop();
+}
+
+void ProcessLogWriter::start(uint32_t interval, size_t bytes, size_t tail) {
+    stop();
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    flushMillis = std::max(uint32_t(1), interval);
+    flushBytes = std::max(size_t(1), bytes);
+    tailLines = std::max(size_t(1), tail);
+    // A reset requested while stopped; stop() joined the writer, so nothing else uses the set
+    if (resetPending) {
+        truncated.clear();
+        resetPending = false;
+    }
+    running = true;
+    writerThread = std::thread(&ProcessLogWriter::writerLoop, this);
+}
+
+// Writes out whatever is still buffered before joining
+void ProcessLogWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        if (!running) return;
+        running = false;
+    }
+    bufferCv.notify_one();
+    if (writerThread.joinable()) writerThread.join();
+}
+
+void ProcessLogWriter::flush() {
+    std::unique_lock<std::mutex> lock(bufferMutex);
+    if (!running) return;
+    uint64_t request = ++flushRequests;
+    bufferCv.notify_one();
+    flushedCv.wait(lock, [&] { return flushesServed >= request || !running; });
+}
+
+void ProcessLogWriter::resetFiles() {
+    std::unique_lock<std::mutex> lock(bufferMutex);
+    resetPending = true;
+    if (!running) return; // start() applies it
+    bufferCv.notify_one();
+    flushedCv.wait(lock, [this] { return !resetPending || !running; });
+}
+
+void ProcessLogWriter::append(const std::string& fileName, const std::string& line) {
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        if (!running) return;
+        Chunks& chunks = frontBuffer[fileName];
+        if (chunks.empty() || chunks.back().size() + line.size() + 1 > CHUNK_BYTES) {
+            chunks.emplace_back();
+            chunks.back().reserve(std::max(CHUNK_BYTES, line.size() + 1));
+        }
+        chunks.back() += line;
+        chunks.back() += '\n';
+        pendingBytes += line.size() + 1;
+        full = pendingBytes >= flushBytes;
+    }
+    if (full) bufferCv.notify_one();
+}
+
+void ProcessLogWriter::writerLoop() {
+    std::filesystem::create_directory(LOG_DIRECTORY);
+    while (true) {
+        uint64_t served;
+        bool reset;
+        {
+            std::unique_lock<std::mutex> lock(bufferMutex);
+            bufferCv.wait_for(lock, std::chrono::milliseconds(flushMillis),
+                [this] { return pendingBytes >= flushBytes || !running || flushRequests > flushesServed || resetPending; });
+            if (frontBuffer.empty() && !running) break;
+            std::swap(frontBuffer, backBuffer);
+            pendingBytes = 0;
+            served = flushRequests;
+            reset = resetPending;
+        }
+        // Lines buffered before a reset still belong to the old files
+        if (!backBuffer.empty()) {
+            for (const auto& [fileName, chunks] : backBuffer) {
+                writeFile(fileName, chunks);
+            }
+            backBuffer.clear();
+            flushes++;
+        }
+        if (reset) {
+            closeFiles();
+            truncated.clear();
+        }
+        {
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            flushesServed = served;
+            if (reset) resetPending = false;
+        }
+        flushedCv.notify_all();
+    }
+    closeFiles();
+    flushedCv.notify_all();
+}
+
+// The first write of a run truncates the file, later ones append
+void ProcessLogWriter::writeFile(const std::string& fileName, const Chunks& chunks) {
+    bool first = truncated.insert(fileName).second;
+    size_t total = 0;
+    for (const auto& chunk : chunks) {
+        total += chunk.size();
+    }
+#ifdef _WIN32
+    std::ofstream file(fileName, std::ios::binary | (first ? std::ios::trunc : std::ios::app));
+    for (const auto& chunk : chunks) {
+        file.write(chunk.data(), chunk.size());
+    }
+    if (!file) return;
+#else
+    int fd = openFile(fileName, first);
+    if (fd < 0) return;
+    std::vector<iovec> iov;
+    iov.reserve(chunks.size());
+    for (const auto& chunk : chunks) {
+        iov.push_back({const_cast<char*>(chunk.data()), chunk.size()});
+    }
+    size_t next = 0;
+    while (next < iov.size()) {
+        int count = static_cast<int>(std::min<size_t>(iov.size() - next, IOV_MAX));
+        ssize_t written = ::writev(fd, iov.data() + next, count);
+        if (written < 0) break;
+        // Step past whatever a short write covered
+        size_t remaining = static_cast<size_t>(written);
+        while (next < iov.size() && remaining >= iov[next].iov_len) {
+            remaining -= iov[next].iov_len;
+            ++next;
+        }
+        if (next < iov.size() && remaining > 0) {
+            iov[next].iov_base = static_cast<char*>(iov[next].iov_base) + remaining;
+            iov[next].iov_len -= remaining;
+        }
+    }
+    if (next < iov.size()) return;
+#endif
+    bytesWritten += total;
+}
+
+// Descriptor for fileName from the open-file cache, opening it and closing the least recently
+// written file when the cache is full. Logs are only written here, so they stay open between flushes.
+#ifndef _WIN32
+int ProcessLogWriter::openFile(const std::string& fileName, bool truncate) {
+    auto found = openFileIndex.find(fileName);
+    if (found != openFileIndex.end()) {
+        // Only files started since the last reset are cached, so this is never a truncating open
+        openFiles.splice(openFiles.begin(), openFiles, found->second);
+        return found->second->second;
+    }
+    int fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_APPEND | (truncate ? O_TRUNC : 0), 0644);
+    if (fd < 0) return -1;
+    if (openFiles.size() >= MAX_OPEN_FILES) {
+        ::close(openFiles.back().second);
+        openFileIndex.erase(openFiles.back().first);
+        openFiles.pop_back();
+    }
+    openFiles.emplace_front(fileName, fd);
+    openFileIndex[fileName] = openFiles.begin();
+    return fd;
+}
+#endif
+
+void ProcessLogWriter::closeFiles() {
+#ifndef _WIN32
+    for (const auto& [fileName, fd] : openFiles) {
+        ::close(fd);
+    }
+#endif
+    openFiles.clear();
+    openFileIndex.clear();
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+// Streams process log lines to files under logs/ from one background thread.
+// append() only copies the line into a per-file chunk list; the writer swaps the whole set out
+// every flush interval (or sooner once flushBytes are pending) and writes each file with writev.
+class ProcessLogWriter {
+public:
+    ProcessLogWriter() = default;
+    ~ProcessLogWriter();
+    ProcessLogWriter(const ProcessLogWriter&) = delete;
+    ProcessLogWriter& operator=(const ProcessLogWriter&) = delete;
+
+    void start(uint32_t flushMillis, size_t flushBytes, size_t tailLines);
+    void stop();
+    void append(const std::string& fileName, const std::string& line);
+    // Blocks until every line appended before the call is on disk
+    void flush();
+    // Writes what is buffered, then forgets which files were started so the next write to each
+    // truncates it again. For when the process table is cleared and pids are handed out anew.
+    void resetFiles();
+    bool isRunning() const { return running.load(); }
+    size_t getTailLines() const { return tailLines; }
+    static constexpr const char* LOG_DIRECTORY = "logs";
+    uint64_t getBytesWritten() const { return bytesWritten.load(); }
+    uint64_t getFlushes() const { return flushes.load(); }
+private:
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;
+    static constexpr size_t MAX_OPEN_FILES = 64;
+    using Chunks = std::vector<std::string>;
+
+    uint32_t flushMillis = 100;
+    size_t flushBytes = 256 * 1024;
+    size_t tailLines = 32;
+    std::unordered_map<std::string, Chunks> frontBuffer;
+    std::unordered_map<std::string, Chunks> backBuffer;
+    size_t pendingBytes = 0;
+    uint64_t flushRequests = 0;
+    uint64_t flushesServed = 0; // Requests covered by a completed write pass
+    bool resetPending = false;
+    std::unordered_set<std::string> truncated; // Files already started since the last reset; writer thread only
+    // Most recently written files first, kept open between flushes; writer thread only
+    std::list<std::pair<std::string, int>> openFiles;
+    std::unordered_map<std::string, std::list<std::pair<std::string, int>>::iterator> openFileIndex;
+    std::mutex bufferMutex;
+    std::condition_variable bufferCv;
+    std::condition_variable flushedCv;
+    std::thread writerThread;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> bytesWritten{0};
+    std::atomic<uint64_t> flushes{0};
+
+    void writerLoop();
+    void writeFile(const std::string& fileName, const Chunks& chunks);
+    int openFile(const std::string& fileName, bool truncate);
+    void closeFiles();
+};
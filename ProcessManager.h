@@ -1,41 +1,145 @@
 #pragma once
 #include <unordered_map>
 #include <vector>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <functional>
 #include "Process.h"
 
 class ProcessManager {
 private:
-    std::unordered_map<int, Process> processes;
+    // Pids are dense and start at 1, so pid - 1 indexes a table of fixed-size chunks.
+    // Chunks are never moved or freed while the manager lives, so Process addresses stay stable
+    // and readers need no lock: a slot is published with a release store after construction.
+    // Retiring publishes a summary in the slot's retired half, then empties the live half.
+    static constexpr size_t CHUNK_SIZE = 1024;
+    static constexpr size_t MAX_CHUNKS = 4096;
+    static constexpr size_t NAME_SHARDS = 16;
+
+    struct Chunk {
+        std::array<std::atomic<Process*>, CHUNK_SIZE> slots{};
+        std::array<std::atomic<RetiredProcess*>, CHUNK_SIZE> retired{};
+    };
+
+    struct NameShard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, int> pids;
+    };
+
+    std::array<std::atomic<Chunk*>, MAX_CHUNKS> chunks{};
+    std::atomic<size_t> published{0}; // Number of slots readers may look at
+    std::mutex createMutex;           // Serializes writers only
     int next_pid;
+    std::array<NameShard, NAME_SHARDS> nameIndex;
+    ProcessLogWriter* logWriter;      // Handed to every new process; may be null
+
+    // Retired processes a reader may still hold. Only the retiring thread touches these:
+    // unlinked gathers retirements until sealRetired(), and sealed waits out one grace period.
+    std::vector<Process*> unlinked;
+    std::vector<Process*> sealed;
+    mutable std::atomic<int> activeReaders{0};
+
+    Chunk* chunkFor(int pid) const {
+        if (pid < 1) return nullptr;
+        size_t index = static_cast<size_t>(pid - 1);
+        if (index >= published.load(std::memory_order_acquire)) return nullptr;
+        return chunks[index / CHUNK_SIZE].load(std::memory_order_acquire);
+    }
+
+    NameShard& shardFor(const std::string& name) {
+        return nameIndex[std::hash<std::string>{}(name) % NAME_SHARDS];
+    }
+    const NameShard& shardFor(const std::string& name) const {
+        return nameIndex[std::hash<std::string>{}(name) % NAME_SHARDS];
+    }
 
 public:
-    ProcessManager() : next_pid(1) {}
+    explicit ProcessManager(ProcessLogWriter* logWriter = nullptr) : next_pid(1), logWriter(logWriter) {}
+    ProcessManager(const ProcessManager&) = delete;
+    ProcessManager& operator=(const ProcessManager&) = delete;
+
+    ~ProcessManager() {
+        clear();
+    }
+
+    // Held by threads other than the scheduler and the cores while they use a Process pointer,
+    // so retirement cannot free it underneath them
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const ProcessManager& manager) : readers(manager.activeReaders) { readers.fetch_add(1); }
+        ~ReadGuard() { readers.fetch_sub(1); }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    private:
+        std::atomic<int>& readers;
+    };
 
     int createProcess(const std::string& name, int core = -1) {
-        int pid = next_pid++;
-        processes.emplace(pid, Process(name, pid, core));
+        std::lock_guard<std::mutex> lock(createMutex);
+        int pid = next_pid;
+        size_t index = static_cast<size_t>(pid - 1);
+        size_t chunkIndex = index / CHUNK_SIZE;
+        if (chunkIndex >= MAX_CHUNKS) return -1;
+
+        Chunk* chunk = chunks[chunkIndex].load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new Chunk();
+            chunks[chunkIndex].store(chunk, std::memory_order_release);
+        }
+        Process* process = new Process(name, pid, core);
+        process->setLogWriter(logWriter);
+        chunk->slots[index % CHUNK_SIZE].store(process, std::memory_order_release);
+        ++next_pid;
+        published.store(index + 1, std::memory_order_release);
+
+        NameShard& shard = shardFor(name);
+        std::unique_lock<std::shared_mutex> nameLock(shard.mutex);
+        shard.pids.insert_or_assign(name, pid); // The newest process owns a reused name
         return pid;
     }
 
+    // Null once the process is retired
     Process* getProcess(int pid) {
-        auto it = processes.find(pid);
-        if (it != processes.end()) {
-            return &(it->second);
-        }
-        return nullptr;
+        Chunk* chunk = chunkFor(pid);
+        return chunk ? chunk->slots[(pid - 1) % CHUNK_SIZE].load(std::memory_order_acquire) : nullptr;
+    }
+
+    const Process* getProcess(int pid) const {
+        return const_cast<ProcessManager*>(this)->getProcess(pid);
+    }
+
+    int findProcessByName(const std::string& name) const {
+        const NameShard& shard = shardFor(name);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.pids.find(name);
+        return it != shard.pids.end() ? it->second : -1;
     }
 
-    std::vector<const Process*> getAllProcesses() const {
-        std::vector<const Process*> process_list;
-        process_list.reserve(processes.size());
-        for (const auto& pair : processes) {
-            process_list.push_back(&pair.second);
+    // Set once the process is retired; stays until clear()
+    const RetiredProcess* getRetiredProcess(int pid) const {
+        Chunk* chunk = chunkFor(pid);
+        return chunk ? chunk->retired[(pid - 1) % CHUNK_SIZE].load(std::memory_order_acquire) : nullptr;
+    }
+
+    // Visits processes in pid order without building a list; retired ones go to visitRetired
+    void forEachProcess(const std::function<void(const Process&)>& visit,
+                        const std::function<void(const RetiredProcess&)>& visitRetired = nullptr) const {
+        ReadGuard guard(*this);
+        size_t count = published.load(std::memory_order_acquire);
+        for (size_t index = 0; index < count; ++index) {
+            int pid = static_cast<int>(index + 1);
+            if (const Process* process = getProcess(pid)) {
+                visit(*process);
+            } else if (const RetiredProcess* retired = getRetiredProcess(pid); retired && visitRetired) {
+                visitRetired(*retired);
+            }
         }
-        return process_list;
     }
 
     size_t getProcessCount() const {
-        return processes.size();
+        return published.load(std::memory_order_acquire);
     }
 
     bool updateProcessUtilization(int pid, int utilization) {
@@ -56,6 +160,139 @@ public:
         return false;
     }
 
+    // Swaps a finished process for its summary. Only the scheduler thread retires; the Process
+    // is freed by freeSealed() once no core or ReadGuard can still hold it.
+    bool retireProcess(int pid, LogRetention retention) {
+        Process* process = getProcess(pid);
+        if (!process || !process->isComplete()) return false;
+        Chunk* chunk = chunkFor(pid);
+        size_t offset = (pid - 1) % CHUNK_SIZE;
+        chunk->retired[offset].store(new RetiredProcess(process->retire(retention)), std::memory_order_release);
+        chunk->slots[offset].store(nullptr);
+        unlinked.push_back(process);
+        return true;
+    }
+
+    // Starts a grace period for the processes retired since the last one, unless one is still
+    // running. True if it started; the caller then waits until every core has moved on.
+    bool sealRetired() {
+        if (!sealed.empty() || unlinked.empty()) return false;
+        sealed.swap(unlinked);
+        return true;
+    }
+
+    bool hasSealedRetired() const { return !sealed.empty(); }
+
+    // Ends the grace period if no ReadGuard is held; the caller vouches for the cores
+    bool freeSealed() {
+        if (activeReaders.load() != 0) return false;
+        for (Process* process : sealed) delete process;
+        sealed.clear();
+        return true;
+    }
+
+    // Deletes every process and starts pids from 1 again, so log files get truncated on reuse. Only
+    // safe while no other thread holds a Process pointer, i.e. with the scheduler stopped and generation off.
+    void clear() {
+        std::lock_guard<std::mutex> lock(createMutex);
+        published.store(0, std::memory_order_release);
+        for (auto& chunkPtr : chunks) {
+            Chunk* chunk = chunkPtr.exchange(nullptr);
+            if (!chunk) continue;
+            for (auto& slot : chunk->slots) {
+                delete slot.exchange(nullptr);
+            }
+            for (auto& slot : chunk->retired) {
+                delete slot.exchange(nullptr);
+            }
+            delete chunk;
+        }
+        for (Process* process : unlinked) delete process;
+        for (Process* process : sealed) delete process;
+        unlinked.clear();
+        sealed.clear();
+        next_pid = 1;
+        for (auto& shard : nameIndex) {
+            std::unique_lock<std::shared_mutex> nameLock(shard.mutex);
+            shard.pids.clear();
+        }
+        if (logWriter) logWriter->resetFiles(); // The same pid-name files will be reused
+    }
+
+    // Processes in pid order; pids are dense, so restoring recreates the same ones
+    void saveState(BinaryWriter& out, std::chrono::steady_clock::time_point now) const {
+        size_t count = getProcessCount();
+        out.putVarint(count);
+        for (size_t index = 0; index < count; ++index) {
+            int pid = static_cast<int>(index + 1);
+            if (const Process* process = getProcess(pid)) {
+                out.putBytes(process->getProcessName());
+                out.putByte(0);
+                process->saveState(out, now);
+                continue;
+            }
+            const RetiredProcess& retired = *getRetiredProcess(pid);
+            out.putBytes(retired.name);
+            out.putByte(1);
+            out.putBytes(retired.createdTimestamp);
+            out.putBytes(retired.finishTimestamp);
+            out.putVarint(static_cast<uint64_t>(retired.cpuUtilization));
+            out.putVarint(retired.dispatchCount);
+            out.putVarint(retired.instructions);
+            out.putVarint(retired.cpuTicks);
+            out.putVarint(retired.turnaroundMillis);
+            for (size_t word = 0; word < retired.coreMask.size() / 64; ++word) {
+                uint64_t bits = 0;
+                for (size_t bit = 0; bit < 64; ++bit) {
+                    if (retired.coreMask.test(word * 64 + bit)) bits |= uint64_t(1) << bit;
+                }
+                out.putFixed64(bits);
+            }
+            out.putBytes(retired.logFile);
+            out.putBytes(retired.logs);
+        }
+    }
+
+    // Same caveat as clear(); false leaves a partial table behind
+    bool restoreState(BinaryReader& in, std::chrono::steady_clock::time_point now) {
+        clear();
+        uint64_t count;
+        if (!in.getVarint(count) || count > CHUNK_SIZE * MAX_CHUNKS) return false;
+        for (uint64_t index = 0; index < count; ++index) {
+            std::string name;
+            uint8_t isRetired;
+            if (!in.getBytes(name) || !in.getByte(isRetired)) return false;
+            int pid = createProcess(name);
+            Process* process = getProcess(pid);
+            if (!process) return false;
+            if (!isRetired) {
+                if (!process->restoreState(in, now)) return false;
+                continue;
+            }
+            auto retired = std::make_unique<RetiredProcess>();
+            retired->name = name;
+            if (!in.getBytes(retired->createdTimestamp) || !in.getBytes(retired->finishTimestamp) ||
+                !in.getVarint(retired->cpuUtilization) || !in.getVarint(retired->dispatchCount) ||
+                !in.getVarint(retired->instructions) || !in.getVarint(retired->cpuTicks) ||
+                !in.getVarint(retired->turnaroundMillis)) {
+                return false;
+            }
+            for (size_t word = 0; word < retired->coreMask.size() / 64; ++word) {
+                uint64_t bits;
+                if (!in.getFixed64(bits)) return false;
+                for (size_t bit = 0; bit < 64; ++bit) {
+                    if (bits & (uint64_t(1) << bit)) retired->coreMask.set(word * 64 + bit);
+                }
+            }
+            if (!in.getBytes(retired->logFile) || !in.getBytes(retired->logs)) return false;
+            Chunk* chunk = chunkFor(pid);
+            size_t offset = (pid - 1) % CHUNK_SIZE;
+            chunk->retired[offset].store(retired.release(), std::memory_order_release);
+            delete chunk->slots[offset].exchange(nullptr);
+        }
+        return true;
+    }
+
     std::string executeProcessInstruction(int pid) {
         auto process = getProcess(pid);
         if (process) {
@@ -63,4 +300,4 @@ public:
         }
         return "Process not found";
     }
-}; 
\ No newline at end of file
+};
@@ -0,0 +1,36 @@
+#include "Profiler.h"
+#include <iomanip>
+
+namespace {
+    double micros(uint64_t nanos) { return nanos / 1000.0; }
+
+    double meanMicros(const DurationStats& stats) {
+        uint64_t count = stats.count.load();
+        return count == 0 ? 0.0 : micros(stats.totalNanos.load()) / count;
+    }
+}
+
+void printLockProfile(std::ostream& out, const ProfiledMutex& mutex) {
+    const DurationStats& wait = mutex.getWaitStats();
+    const DurationStats& hold = mutex.getHoldStats();
+    uint64_t acquisitions = wait.count.load();
+    double contendedPct = acquisitions == 0 ? 0.0 : 100.0 * mutex.getContended() / acquisitions;
+    out << std::left << std::setw(24) << mutex.getName() << std::right << std::fixed << std::setprecision(2)
+        << std::setw(10) << acquisitions
+        << std::setw(10) << contendedPct << "%"
+        << std::setw(12) << micros(wait.totalNanos.load())
+        << std::setw(10) << meanMicros(wait)
+        << std::setw(10) << micros(wait.maxNanos.load())
+        << std::setw(12) << micros(hold.totalNanos.load())
+        << std::setw(10) << meanMicros(hold)
+        << std::setw(10) << micros(hold.maxNanos.load()) << "\n";
+}
+
+void printSectionProfile(std::ostream& out, const ProfiledSection& section) {
+    const DurationStats& time = section.time;
+    out << std::left << std::setw(24) << section.name << std::right << std::fixed << std::setprecision(2)
+        << std::setw(10) << time.count.load()
+        << std::setw(14) << micros(time.totalNanos.load())
+        << std::setw(10) << meanMicros(time)
+        << std::setw(10) << micros(time.maxNanos.load()) << "\n";
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+
+// Lock-free counters shared by the profiled mutex and the scoped timers
+struct DurationStats {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> totalNanos{0};
+    std::atomic<uint64_t> maxNanos{0};
+
+    void add(uint64_t nanos) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+        uint64_t seen = maxNanos.load(std::memory_order_relaxed);
+        while (nanos > seen && !maxNanos.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {}
+    }
+    void reset() {
+        count.store(0);
+        totalNanos.store(0);
+        maxNanos.store(0);
+    }
+};
+
+// Drop-in std::mutex replacement that records how long callers waited to acquire it and how
+// long it was held. The uncontended path costs one try_lock and two clock reads.
+class ProfiledMutex {
+public:
+    explicit ProfiledMutex(const char* name) : name(name) {}
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+    void lock() {
+        std::chrono::steady_clock::time_point start;
+        bool waited = !mutex.try_lock();
+        if (waited) {
+            start = std::chrono::steady_clock::now();
+            mutex.lock();
+        }
+        acquiredAt = std::chrono::steady_clock::now();
+        if (waited) contended.fetch_add(1, std::memory_order_relaxed);
+        wait.add(waited ? elapsedNanos(start, acquiredAt) : 0);
+    }
+
+    bool try_lock() {
+        if (!mutex.try_lock()) return false;
+        wait.add(0);
+        acquiredAt = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void unlock() {
+        hold.add(elapsedNanos(acquiredAt, std::chrono::steady_clock::now()));
+        mutex.unlock();
+    }
+
+    const char* getName() const { return name; }
+    const DurationStats& getWaitStats() const { return wait; }
+    const DurationStats& getHoldStats() const { return hold; }
+    uint64_t getContended() const { return contended.load(std::memory_order_relaxed); }
+    void reset() {
+        wait.reset();
+        hold.reset();
+        contended.store(0);
+    }
+private:
+    const char* name;
+    std::mutex mutex;
+    std::chrono::steady_clock::time_point acquiredAt; // Only touched by the holder
+    DurationStats wait;
+    DurationStats hold;
+    std::atomic<uint64_t> contended{0};
+
+    static uint64_t elapsedNanos(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+    }
+};
+
+// A named block of code whose calls are counted and timed
+struct ProfiledSection {
+    explicit ProfiledSection(const char* name) : name(name) {}
+    const char* name;
+    DurationStats time;
+};
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(ProfiledSection& section)
+        : section(section), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        section.time.add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+private:
+    ProfiledSection& section;
+    std::chrono::steady_clock::time_point start;
+};
+
+void printLockProfile(std::ostream& out, const ProfiledMutex& mutex);
+void printSectionProfile(std::ostream& out, const ProfiledSection& section);
@@ -0,0 +1,202 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <random>
+#include <mutex>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <sstream>
+#include "Process.h"
+#include "ProcessInstruction.h"
+#include "Config.h"
+
+// Random process programs and memory sizes for the dummy process generator and screen -s
+class ProgramGenerator {
+private:
+    std::mt19937 rng;
+    std::mutex rngMutex; // The generator thread and the console both draw from it
+
+public:
+    static constexpr uint32_t DEFAULT_MEM_PER_PROC = 4096;
+
+    explicit ProgramGenerator(uint32_t seed = std::random_device{}()) : rng(seed) {}
+
+    void reseed(uint32_t seed) {
+        std::lock_guard<std::mutex> lock(rngMutex);
+        rng.seed(seed);
+    }
+
+    // Engine state as text, so a restored run keeps drawing the same sequence
+    std::string saveState() {
+        std::lock_guard<std::mutex> lock(rngMutex);
+        std::ostringstream out;
+        out << rng;
+        return out.str();
+    }
+
+    bool restoreState(const std::string& state) {
+        std::lock_guard<std::mutex> lock(rngMutex);
+        std::istringstream in(state);
+        std::mt19937 restored;
+        if (!(in >> restored)) return false;
+        rng = restored;
+        return true;
+    }
+
+    // Power-of-two size in [min-mem-per-proc, max-mem-per-proc]; a bound left at 0 takes the
+    // other, and DEFAULT_MEM_PER_PROC stands in when neither is set
+    int drawMemorySize(const SystemConfig& config) {
+        std::lock_guard<std::mutex> lock(rngMutex);
+        uint32_t minSize = config.minMemPerProc ? config.minMemPerProc : config.maxMemPerProc;
+        uint32_t maxSize = config.maxMemPerProc ? config.maxMemPerProc : minSize;
+        if (minSize == 0) minSize = maxSize = DEFAULT_MEM_PER_PROC;
+        int minExp = std::bit_width(minSize) - 1;
+        int maxExp = std::bit_width(maxSize) - 1;
+        if (maxExp < minExp) maxExp = minExp;
+        return 1 << std::uniform_int_distribution<int>(minExp, maxExp)(rng);
+    }
+
+    // Fills proc with a random program sized by min-ins/max-ins; proc's memory size must be set
+    void generate(Process* proc, const SystemConfig& config) {
+        std::lock_guard<std::mutex> lock(rngMutex);
+        int instructionCount = std::uniform_int_distribution<int>(
+            config.minInstructions, config.maxInstructions)(rng);
+
+        std::vector<std::string> declaredVars;
+        std::vector<std::unique_ptr<IProcessInstruction>> instructions;
+
+        // Prepare DECLARE instructions
+        int numVars = std::max(1, std::uniform_int_distribution<int>(1, 3)(rng));
+        for (int v = 0; v < numVars; ++v) {
+            std::string var = "v" + std::to_string(v + 1);
+            uint16_t value = std::uniform_int_distribution<uint16_t>(0, 100)(rng);
+            declaredVars.push_back(var);
+            instructions.push_back(std::make_unique<DeclareInstruction>(var, value));
+        }
+
+        // Other instructions
+        int i = 0;
+        while (i < instructionCount) {
+            int choice = std::uniform_int_distribution<int>(0, 7)(rng);
+            switch (choice) {
+                case 0: // ADD
+                    if (!declaredVars.empty()) {
+                        // 3 variables to use
+                        std::string var1 = declaredVars.size() > 0 ? declaredVars[0] : "v1";
+                        std::string var2 = declaredVars.size() > 1 ? declaredVars[1] : "v2";
+                        std::string var3 = declaredVars.size() > 2 ? declaredVars[2] : "v3";
+                        instructions.push_back(std::make_unique<AddInstruction>(var1, var2, var3));
+                        ++i;
+                    }
+                    break;
+
+                case 1: // SUBTRACT
+                    if (!declaredVars.empty()) {
+                        std::string var1 = declaredVars.size() > 0 ? declaredVars[0] : "v1";
+                        std::string var2 = declaredVars.size() > 1 ? declaredVars[1] : "v2";
+                        std::string var3 = declaredVars.size() > 2 ? declaredVars[2] : "v3";
+                        instructions.push_back(std::make_unique<SubtractInstruction>(var1, var2, var3));
+                        ++i;
+                    }
+                    break;
+
+                case 2: // SLEEP
+                    {
+                        int ticks = std::uniform_int_distribution<int>(1, 5)(rng);
+                        instructions.push_back(std::make_unique<SleepInstruction>(ticks));
+                        ++i;
+                    }
+                    break;
+
+                case 3: // PRINT
+                    {
+                        std::string message = "Hello world from " + proc->getProcessName() + "!";
+                        instructions.push_back(std::make_unique<PrintInstruction>(message));
+                        ++i;
+                    }
+                    break;
+
+                case 4: // FOR
+                    if (i + 4 < instructionCount && !declaredVars.empty()) {
+                        int bodyCount = std::min(instructionCount - i - 2, std::uniform_int_distribution<int>(2, 3)(rng));
+                        std::vector<std::unique_ptr<IProcessInstruction>> bodyInstructions;
+                        for (int b = 0; b < bodyCount; ++b) {
+                            int bodyChoice = std::uniform_int_distribution<int>(0, 2)(rng);
+                            switch (bodyChoice) {
+                                case 0:
+                                    {
+                                        std::string var1 = declaredVars.size() > 0 ? declaredVars[0] : "v1";
+                                        std::string var2 = declaredVars.size() > 1 ? declaredVars[1] : "v2";
+                                        std::string var3 = declaredVars.size() > 2 ? declaredVars[2] : "v3";
+                                        bodyInstructions.push_back(std::make_unique<AddInstruction>(var1, var2, var3));
+                                    }
+                                    break;
+                                case 1:
+                                    {
+                                        std::string var1 = declaredVars.size() > 0 ? declaredVars[0] : "v1";
+                                        std::string var2 = declaredVars.size() > 1 ? declaredVars[1] : "v2";
+                                        std::string var3 = declaredVars.size() > 2 ? declaredVars[2] : "v3";
+                                        bodyInstructions.push_back(std::make_unique<SubtractInstruction>(var1, var2, var3));
+                                    }
+                                    break;
+                                default:
+                                    {
+                                        std::string message = "Hello world from " + proc->getProcessName() + "!";
+                                        bodyInstructions.push_back(std::make_unique<PrintInstruction>(message));
+                                    }
+                                    break;
+                            }
+                        }
+                        int repeats = std::uniform_int_distribution<int>(2, 4)(rng);
+                        instructions.push_back(std::make_unique<ForInstruction>(std::move(bodyInstructions), repeats));
+                        i += 2;
+                    } else {
+                        std::string message = "Hello world from " + proc->getProcessName() + "!";
+                        instructions.push_back(std::make_unique<PrintInstruction>(message));
+                        ++i;
+                    }
+                    break;
+
+                case 6: // READ
+                    if (proc->getMemorySize() >= 2) {
+                        instructions.push_back(std::make_unique<ReadInstruction>(declaredVars[0], randomMemoryAddress(proc)));
+                        ++i;
+                    }
+                    break;
+
+                case 7: // WRITE
+                    if (proc->getMemorySize() >= 2) {
+                        std::string value = declaredVars[std::uniform_int_distribution<size_t>(0, declaredVars.size() - 1)(rng)];
+                        instructions.push_back(std::make_unique<WriteInstruction>(randomMemoryAddress(proc), value));
+                        ++i;
+                    }
+                    break;
+
+                default:
+                    {
+                        std::string message = "Hello world from " + proc->getProcessName() + "!";
+                        instructions.push_back(std::make_unique<PrintInstruction>(message));
+                        ++i;
+                    }
+                    break;
+            }
+        }
+
+        // Shuffle all instructions
+        std::shuffle(instructions.begin(), instructions.end(), rng);
+
+        // Add all instructions to the process
+        for (auto& instr : instructions) {
+            proc->addInstruction(std::move(instr));
+        }
+    }
+
+private:
+    // Even address so a uint16 access stays inside the process's memory
+    uint32_t randomMemoryAddress(Process* proc) {
+        uint32_t words = static_cast<uint32_t>(proc->getMemorySize()) / 2;
+        return std::uniform_int_distribution<uint32_t>(0, words - 1)(rng) * 2;
+    }
+};
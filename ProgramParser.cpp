@@ -0,0 +1,292 @@
+#include "ProgramParser.h"
+#include "MappedFile.h"
+#include "BinaryCodec.h"
+#include <charconv>
+#include <cctype>
+
+namespace {
+    constexpr int MAX_FOR_NESTING = 3; // ForInstruction::execute skips anything deeper
+
+    using InstructionList = std::vector<std::unique_ptr<IProcessInstruction>>;
+
+    bool isIdentifierStart(char c) { return std::isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+    bool isIdentifierChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+
+    bool keywordIs(std::string_view word, std::string_view keyword) {
+        if (word.size() != keyword.size()) return false;
+        for (size_t i = 0; i < word.size(); ++i) {
+            if (std::toupper(static_cast<unsigned char>(word[i])) != keyword[i]) return false;
+        }
+        return true;
+    }
+
+    // Single pass over the source; names and literals are views into it until an instruction
+    // is built, so the only copies are the strings the instructions keep
+    class Parser {
+    public:
+        explicit Parser(std::string_view source)
+            : pos(source.data()), end(source.data() + source.size()), lineStart(source.data()) {}
+
+        bool parse(CompiledProgram& program, std::string& error) {
+            size_t effective = 0;
+            bool ok = statements(program.instructions, effective, 0);
+            if (ok && program.instructions.empty()) ok = fail("program has no instructions");
+            if (!ok) {
+                error = message;
+                return false;
+            }
+            program.effectiveInstructions = effective;
+            return true;
+        }
+
+    private:
+        const char* pos;
+        const char* end;
+        const char* lineStart;
+        int line = 1;
+        std::string message;
+
+        bool fail(const std::string& what) {
+            message = std::to_string(line) + ":" + std::to_string(pos - lineStart + 1) + ": " + what;
+            return false;
+        }
+
+        // Whitespace, newlines and comments
+        void skipSpace() {
+            while (pos < end) {
+                char c = *pos;
+                if (c == '\n') {
+                    ++line;
+                    lineStart = ++pos;
+                } else if (c == ' ' || c == '\t' || c == '\r') {
+                    ++pos;
+                } else if (c == '#' || (c == '/' && pos + 1 < end && pos[1] == '/')) {
+                    while (pos < end && *pos != '\n') ++pos;
+                } else {
+                    return;
+                }
+            }
+        }
+
+        bool accept(char c) {
+            skipSpace();
+            if (pos < end && *pos == c) {
+                ++pos;
+                return true;
+            }
+            return false;
+        }
+
+        bool expect(char c) {
+            return accept(c) || fail(std::string("expected '") + c + "'");
+        }
+
+        bool identifier(std::string_view& name) {
+            skipSpace();
+            if (pos >= end || !isIdentifierStart(*pos)) return fail("expected a name");
+            const char* start = pos;
+            while (pos < end && isIdentifierChar(*pos)) ++pos;
+            name = std::string_view(start, pos - start);
+            return true;
+        }
+
+        bool number(uint64_t max, uint64_t& value) {
+            skipSpace();
+            const char* start = pos;
+            int base = 10;
+            if (end - pos > 2 && pos[0] == '0' && (pos[1] == 'x' || pos[1] == 'X')) {
+                pos += 2;
+                base = 16;
+            }
+            auto [next, result] = std::from_chars(pos, end, value, base);
+            if (result == std::errc::result_out_of_range || (result == std::errc() && value > max)) {
+                pos = start;
+                return fail("number out of range (max " + std::to_string(max) + ")");
+            }
+            if (result != std::errc() || (next < end && isIdentifierChar(*next))) {
+                pos = start;
+                return fail("expected a number");
+            }
+            pos = next;
+            return true;
+        }
+
+        // A variable name, or a literal kept as decimal text for Process::getVariableValue
+        bool operand(std::string& text) {
+            skipSpace();
+            if (pos < end && isIdentifierStart(*pos)) {
+                std::string_view name;
+                identifier(name);
+                text.assign(name);
+                return true;
+            }
+            uint64_t value;
+            if (!number(UINT16_MAX, value)) return false;
+            text = std::to_string(value);
+            return true;
+        }
+
+        // PRINT terms joined by '+': string literals are copied, variables become the "+name"
+        // the runtime interpolates. That scan reads '+' and then every name character, so text
+        // that would extend a name or start one after a literal '+' is rejected here
+        bool printMessage(std::string& text) {
+            skipSpace();
+            if (pos < end && *pos == ')') return true;
+            size_t nameEnd = std::string::npos; // text.size() right after the last variable
+            auto appendLiteral = [&](char c) {
+                if (text.size() == nameEnd && isIdentifierChar(c)) {
+                    return fail("text after a variable must not start with a letter, digit or '_'");
+                }
+                if (!text.empty() && text.back() == '+' && isIdentifierStart(c)) {
+                    return fail("'+' followed by a name inside a string would print a variable");
+                }
+                text += c;
+                return true;
+            };
+            do {
+                skipSpace();
+                const char* term = pos;
+                if (pos < end && *pos == '"') {
+                    ++pos;
+                    while (pos < end && *pos != '"' && *pos != '\n') {
+                        if (*pos == '\\' && pos + 1 < end && (pos[1] == '"' || pos[1] == '\\')) ++pos;
+                        if (!appendLiteral(*pos)) return false;
+                        ++pos;
+                    }
+                    if (pos >= end || *pos != '"') {
+                        pos = term;
+                        return fail("unterminated string");
+                    }
+                    ++pos;
+                } else if (pos < end && isIdentifierStart(*pos)) {
+                    std::string_view name;
+                    identifier(name);
+                    text += '+';
+                    text.append(name);
+                    nameEnd = text.size();
+                } else {
+                    uint64_t value;
+                    if (!number(UINT16_MAX, value)) return fail("expected a string, name or number");
+                    const char* after = pos;
+                    pos = term;
+                    for (char c : std::to_string(value)) {
+                        if (!appendLiteral(c)) return false;
+                    }
+                    pos = after;
+                }
+            } while (accept('+'));
+            return true;
+        }
+
+        // Statements up to the end of input (depth 0) or a FOR body's closing ']'
+        bool statements(InstructionList& out, size_t& effective, int depth) {
+            while (true) {
+                skipSpace();
+                while (pos < end && (*pos == ';' || (depth > 0 && *pos == ','))) {
+                    ++pos;
+                    skipSpace();
+                }
+                if (pos >= end) return depth == 0 || fail("expected ']'");
+                if (depth > 0 && *pos == ']') return true;
+                if (!statement(out, effective, depth)) return false;
+            }
+        }
+
+        bool statement(InstructionList& out, size_t& effective, int depth) {
+            const char* start = pos;
+            std::string_view keyword;
+            if (!identifier(keyword) || !expect('(')) return false;
+            std::string first, second, third;
+            uint64_t value;
+
+            if (keywordIs(keyword, "DECLARE")) {
+                std::string_view name;
+                if (!identifier(name) || !expect(',') || !number(UINT16_MAX, value) || !expect(')')) return false;
+                out.push_back(std::make_unique<DeclareInstruction>(std::string(name), static_cast<uint16_t>(value)));
+            } else if (keywordIs(keyword, "ADD") || keywordIs(keyword, "SUBTRACT")) {
+                std::string_view name;
+                if (!identifier(name) || !expect(',') || !operand(second) || !expect(',') ||
+                    !operand(third) || !expect(')')) {
+                    return false;
+                }
+                first.assign(name);
+                if (keywordIs(keyword, "ADD")) {
+                    out.push_back(std::make_unique<AddInstruction>(first, second, third));
+                } else {
+                    out.push_back(std::make_unique<SubtractInstruction>(first, second, third));
+                }
+            } else if (keywordIs(keyword, "PRINT")) {
+                if (!printMessage(first) || !expect(')')) return false;
+                out.push_back(std::make_unique<PrintInstruction>(first));
+            } else if (keywordIs(keyword, "SLEEP")) {
+                if (!number(UINT8_MAX, value) || !expect(')')) return false;
+                out.push_back(std::make_unique<SleepInstruction>(static_cast<int>(value)));
+            } else if (keywordIs(keyword, "READ")) {
+                std::string_view name;
+                if (!identifier(name) || !expect(',') || !number(UINT32_MAX, value) || !expect(')')) return false;
+                out.push_back(std::make_unique<ReadInstruction>(std::string(name), static_cast<uint32_t>(value)));
+            } else if (keywordIs(keyword, "WRITE")) {
+                if (!number(UINT32_MAX, value) || !expect(',') || !operand(second) || !expect(')')) return false;
+                out.push_back(std::make_unique<WriteInstruction>(static_cast<uint32_t>(value), second));
+            } else if (keywordIs(keyword, "FOR")) {
+                if (depth >= MAX_FOR_NESTING) {
+                    pos = start;
+                    return fail("FOR nested more than " + std::to_string(MAX_FOR_NESTING) + " deep");
+                }
+                InstructionList body;
+                size_t bodyEffective = 0;
+                if (!expect('[') || !statements(body, bodyEffective, depth + 1) || !expect(']') ||
+                    !expect(',') || !number(UINT16_MAX, value) || !expect(')')) {
+                    return false;
+                }
+                out.push_back(std::make_unique<ForInstruction>(std::move(body), static_cast<int>(value)));
+                effective += bodyEffective * value;
+                return true;
+            } else {
+                pos = start;
+                return fail("unknown instruction '" + std::string(keyword) + "'");
+            }
+            ++effective;
+            return true;
+        }
+    };
+}
+
+bool parseProgram(std::string_view source, CompiledProgram& program, std::string& error) {
+    program.instructions.clear();
+    program.effectiveInstructions = 0;
+    return Parser(source).parse(program, error);
+}
+
+std::shared_ptr<const CompiledProgram> ProgramCache::load(const std::string& path, std::string& error, bool* cached) {
+    if (cached) *cached = false;
+    MappedFile file;
+    if (!file.open(path)) {
+        error = "could not open " + path;
+        return nullptr;
+    }
+    std::string_view text = file.contents();
+    uint64_t hash = fnv1a(text.data(), text.size());
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = entries.find(hash);
+    if (it != entries.end() && it->second.size == text.size()) {
+        if (auto program = it->second.program.lock()) {
+            ++hits;
+            if (cached) *cached = true;
+            return program;
+        }
+    }
+
+    auto program = std::make_shared<CompiledProgram>();
+    std::string parseError;
+    if (!parseProgram(text, *program, parseError)) {
+        error = path + ":" + parseError;
+        return nullptr;
+    }
+    ++misses;
+    // Programs no process runs any more are parsed again next time
+    std::erase_if(entries, [](const auto& entry) { return entry.second.program.expired(); });
+    entries[hash] = Entry{text.size(), program};
+    return program;
+}
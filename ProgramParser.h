@@ -0,0 +1,46 @@
+#pragma once
+#include "ProcessInstruction.h"
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+/*
+Program file syntax, one instruction per line or separated by ';' ('#' and '//' start comments):
+  DECLARE(x, 5)             ADD(x, x, 1)          SUBTRACT(y, x, 0x10)
+  PRINT("x is " + x)        SLEEP(3)              READ(v, 0x40)          WRITE(0x40, x)
+  FOR([ADD(x, x, 1), PRINT("tick " + x)], 4)      FOR bodies nest up to three deep
+Keywords are case-insensitive; numbers are decimal or 0x hex.
+*/
+
+// Parses source into program. On failure returns false with "line:column: message" in error.
+bool parseProgram(std::string_view source, CompiledProgram& program, std::string& error);
+
+// Compiled programs keyed by a hash of the file contents, so every process started from the same
+// text shares one instruction list. An entry lasts while some process still runs its program.
+class ProgramCache {
+public:
+    // Null with error set if the file cannot be read or parsed; cached reports a hit
+    std::shared_ptr<const CompiledProgram> load(const std::string& path, std::string& error, bool* cached = nullptr);
+
+    uint64_t getHits() const {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        return hits;
+    }
+    uint64_t getMisses() const {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        return misses;
+    }
+
+private:
+    struct Entry {
+        size_t size = 0; // Checked along with the hash
+        std::weak_ptr<const CompiledProgram> program;
+    };
+    mutable std::mutex cacheMutex;
+    std::unordered_map<uint64_t, Entry> entries;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
@@ -0,0 +1,281 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+#include "Config.h"
+#include "Simulation.h"
+
+/*
+End-to-end scaling sweep: runs the real Scheduler headless for every combination of cores,
+process count, program length, scheduler and allocator, and writes one CSV row per point.
+  scalebench [results.csv] [--quick] [--config file] [--cores 1,2,4] [--processes 1000,10000]
+             [--instructions 100,1000] [--schedulers fcfs,rr] [--allocators first-fit,best-fit]
+             [--max-seconds 60] [--in-flight N] [--jobs N]
+Points run with tick-ms 0 so the cores are not paced by wall-clock sleeps. With --jobs, that many
+points run at once, each in its own Simulation; rows are still written in sweep order.
+*/
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Sweep {
+        std::vector<int> cores{1, 2, 4, 8, 16, 32, 64, 128};
+        std::vector<uint64_t> processes{1000, 10000, 100000, 1000000};
+        std::vector<uint32_t> instructions{100, 1000};
+        std::vector<std::string> schedulers{"fcfs", "rr"};
+        std::vector<std::string> allocators{"first-fit", "best-fit"};
+        double maxSeconds = 60.0;
+        uint64_t inFlight = 0; // 0 = 64 per core
+        unsigned jobs = 1;
+    };
+
+    struct Point {
+        int cores;
+        uint64_t processes;
+        uint32_t instructions;
+        std::string scheduler;
+        std::string allocator;
+    };
+
+    struct PointResult {
+        int cores = 0;
+        uint64_t processes = 0;
+        uint32_t instructions = 0;
+        std::string scheduler;
+        std::string allocator;
+        uint64_t created = 0;
+        uint64_t completed = 0;
+        uint64_t executed = 0;
+        uint64_t ticks = 0;
+        double seconds = 0.0;
+        uint64_t peakRssKb = 0;
+        bool rssMeasured = false; // Only when points run one at a time; the mark is process-wide
+        uint64_t dispatchP50 = 0; // Ready-queue wait before dispatch, microseconds
+        uint64_t dispatchP99 = 0;
+        uint64_t dispatchMax = 0;
+        uint64_t memoryStalls = 0;
+        bool timedOut = false;
+    };
+
+    // Process-wide high-water mark, so it only grows across points
+    uint64_t peakRssKb() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+        return counters.PeakWorkingSetSize / 1024;
+#else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return static_cast<uint64_t>(usage.ru_maxrss) / 1024;
+#else
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#endif
+    }
+
+    template <typename T>
+    bool parseList(const std::string& text, std::vector<T>& out) {
+        out.clear();
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            std::istringstream value(item);
+            T parsed;
+            if (!(value >> parsed)) return false;
+            out.push_back(parsed);
+        }
+        return !out.empty();
+    }
+
+    PointResult runPoint(const SystemConfig& base, const Sweep& sweep, const Point& point) {
+        SystemConfig config = base;
+        config.numCPU = point.cores;
+        config.minInstructions = config.maxInstructions = point.instructions;
+        config.scheduler = point.scheduler;
+        config.memAllocPolicy = point.allocator;
+        config.tickMillis = 0;
+        config.delaysPerExec = 0;
+        config.retireLogs = "drop";
+        config.traceEvents = false;
+        config.utilizationSampleTicks = 0;
+
+        // Only a bounded window of processes is live at once, like a steady arrival stream
+        const uint64_t inFlight = sweep.inFlight ? sweep.inFlight : 64 * static_cast<uint64_t>(point.cores);
+        SimulationResult run = Simulation(config).run(point.processes, inFlight, sweep.maxSeconds);
+
+        PointResult result;
+        result.cores = point.cores;
+        result.processes = point.processes;
+        result.instructions = point.instructions;
+        result.scheduler = point.scheduler;
+        result.allocator = point.allocator;
+        result.created = run.created;
+        result.completed = run.completed;
+        result.executed = run.executed;
+        result.ticks = run.ticks;
+        result.seconds = run.seconds;
+        result.dispatchP50 = run.dispatchP50;
+        result.dispatchP99 = run.dispatchP99;
+        result.dispatchMax = run.dispatchMax;
+        result.memoryStalls = run.memoryStalls;
+        result.timedOut = run.timedOut;
+        if (sweep.jobs == 1) {
+            result.peakRssKb = peakRssKb();
+            result.rssMeasured = true;
+        }
+        return result;
+    }
+
+    double perSecond(uint64_t count, double seconds) {
+        return seconds > 0 ? count / seconds : 0.0;
+    }
+
+    void writeCsvHeader(std::ostream& out) {
+        out << "cores,processes,instructions,scheduler,allocator,created,completed,executed_instructions,ticks,"
+               "seconds,instructions_per_sec,ticks_per_sec,process_peak_rss_kb,dispatch_p50_us,dispatch_p99_us,"
+               "dispatch_max_us,memory_stalls,timed_out\n";
+    }
+
+    void writeCsvRow(std::ostream& out, const PointResult& r) {
+        out << r.cores << "," << r.processes << "," << r.instructions << "," << r.scheduler << "," << r.allocator
+            << "," << r.created << "," << r.completed << "," << r.executed << "," << r.ticks << ","
+            << std::fixed << std::setprecision(3) << r.seconds << "," << perSecond(r.executed, r.seconds) << ","
+            << perSecond(r.ticks, r.seconds) << "," << (r.rssMeasured ? std::to_string(r.peakRssKb) : "") << "," << r.dispatchP50 << "," << r.dispatchP99
+            << "," << r.dispatchMax << "," << r.memoryStalls << "," << (r.timedOut ? 1 : 0) << "\n";
+    }
+
+    void printSummary(std::ostream& out, const std::vector<PointResult>& results) {
+        out << "cores  processes   ins  sched  allocator    done%     instr/s     ticks/s   rss(MB)  p99 wait(ms)   stalls\n";
+        for (const PointResult& r : results) {
+            out << std::right << std::setw(5) << r.cores << std::setw(11) << r.processes << std::setw(6) << r.instructions
+                << "  " << std::left << std::setw(5) << r.scheduler << "  " << std::setw(10) << r.allocator << std::right
+                << std::fixed << std::setprecision(1)
+                << std::setw(8) << (r.processes ? 100.0 * r.completed / r.processes : 0.0)
+                << std::setprecision(0)
+                << std::setw(12) << perSecond(r.executed, r.seconds)
+                << std::setw(12) << perSecond(r.ticks, r.seconds)
+                << std::setprecision(1);
+            if (r.rssMeasured) {
+                out << std::setw(10) << r.peakRssKb / 1024.0;
+            } else {
+                out << std::setw(10) << "-";
+            }
+            out << std::setprecision(2)
+                << std::setw(14) << r.dispatchP99 / 1000.0
+                << std::setw(9) << r.memoryStalls << (r.timedOut ? "  (timed out)" : "") << "\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Sweep sweep;
+    SystemConfig base;
+    base.maxOverallMem = 16384;
+    base.memPerFrame = 16;
+    base.minMemPerProc = 1024;
+    base.maxMemPerProc = 4096;
+    base.quantumCycles = 4;
+    std::string outputPath = "scalebench.csv";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value = (i + 1 < argc) ? argv[i + 1] : "";
+        bool ok = true;
+        if (arg == "--quick") {
+            sweep.cores = {1, 2, 4};
+            sweep.processes = {1000};
+            sweep.instructions = {100};
+            sweep.allocators = {"first-fit"};
+            sweep.maxSeconds = 10.0;
+            continue;
+        }
+        if (arg.rfind("--", 0) != 0) {
+            outputPath = arg;
+            continue;
+        }
+        ++i;
+        if (arg == "--config") ok = readConfigFromFile(value, base);
+        else if (arg == "--cores") ok = parseList(value, sweep.cores);
+        else if (arg == "--processes") ok = parseList(value, sweep.processes);
+        else if (arg == "--instructions") ok = parseList(value, sweep.instructions);
+        else if (arg == "--schedulers") ok = parseList(value, sweep.schedulers);
+        else if (arg == "--allocators") ok = parseList(value, sweep.allocators);
+        else if (arg == "--max-seconds") ok = (std::istringstream(value) >> sweep.maxSeconds) && sweep.maxSeconds > 0;
+        else if (arg == "--in-flight") ok = static_cast<bool>(std::istringstream(value) >> sweep.inFlight);
+        else if (arg == "--jobs") ok = (std::istringstream(value) >> sweep.jobs) && sweep.jobs > 0;
+        else ok = false;
+        if (!ok) {
+            std::cerr << "Error: Bad argument " << arg << " " << value << "\n";
+            return 1;
+        }
+    }
+
+    std::ofstream csv(outputPath);
+    if (!csv) {
+        std::cerr << "Error: Could not write " << outputPath << "\n";
+        return 1;
+    }
+    writeCsvHeader(csv);
+
+    std::vector<Point> points;
+    for (uint64_t processes : sweep.processes) {
+        for (uint32_t instructions : sweep.instructions) {
+            for (const std::string& scheduler : sweep.schedulers) {
+                for (const std::string& allocator : sweep.allocators) {
+                    for (int cores : sweep.cores) {
+                        points.push_back({cores, processes, instructions, scheduler, allocator});
+                    }
+                }
+            }
+        }
+    }
+
+    // Workers take the next point; finished rows go out as soon as every earlier one has
+    std::vector<PointResult> results(points.size());
+    std::vector<bool> finished(points.size(), false);
+    size_t written = 0;
+    std::mutex outputMutex;
+    std::atomic<size_t> nextPoint{0};
+    auto worker = [&] {
+        for (size_t index = nextPoint++; index < points.size(); index = nextPoint++) {
+            const Point& point = points[index];
+            PointResult result = runPoint(base, sweep, point);
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cerr << "cores=" << point.cores << " processes=" << point.processes << " instructions=" << point.instructions
+                      << " scheduler=" << point.scheduler << " allocator=" << point.allocator << ": "
+                      << std::fixed << std::setprecision(2) << result.seconds << "s\n";
+            results[index] = std::move(result);
+            finished[index] = true;
+            for (; written < points.size() && finished[written]; ++written) {
+                writeCsvRow(csv, results[written]);
+            }
+            csv.flush();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < std::min<size_t>(sweep.jobs, points.size()); ++i) pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool) thread.join();
+
+    printSummary(std::cout, results);
+    std::cerr << "Wrote " << results.size() << " points to " << outputPath << "\n";
+    return 0;
+}
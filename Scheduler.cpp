@@ -2,19 +2,19 @@
 #include <atomic>
 #include <thread>
 #include <chrono>
+#include <iomanip>
+#include <algorithm>
 #include "FirstFitMemoryAllocator.h"
 
-// Global CPU tick counter
-std::atomic<uint64_t> cpuTickCount{0};
-
 // Waiting queue
 void Scheduler::addToWaitingQueue(int pid, int sleepTicks) {
-    std::lock_guard<std::mutex> lock(queueMutex);
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
     waitingQueue.push_back({pid, sleepTicks});
 }
 
 void Scheduler::checkWaitingQueue() {
-    std::lock_guard<std::mutex> lock(queueMutex);
+    ScopedTimer timer(profile.checkWaitingQueue);
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
     for (auto it = waitingQueue.begin(); it != waitingQueue.end(); ) {
         int pid = it->first;
         int& ticks = it->second;
@@ -24,7 +24,8 @@ void Scheduler::checkWaitingQueue() {
             ticks = process->getSleepTicks();
         }
         if (!process || process->getSleepTicks() <= 0) {
-            readyQueue.push(pid);
+            tracer.record(EventTracer::SCHEDULER_RING, TraceEventType::WAKE, pid, -1);
+            enqueueReady(pid);
             it = waitingQueue.erase(it);
         } else {
             ++it;
@@ -32,23 +33,130 @@ void Scheduler::checkWaitingQueue() {
     }
 }
 
+// Caller holds queueMutex
+void Scheduler::enqueueReady(int pid) {
+    if (Process* process = processManager.getProcess(pid)) {
+        process->markReady(std::chrono::steady_clock::now(), cpuTickCount.load());
+    }
+    readyQueue.push(pid);
+}
+
+// Memory wait queue
+void Scheduler::parkForMemory(int pid, int size) {
+    uint64_t key = (settings.current().memoryWaitOrder == MemoryWaitOrder::SIZE) ? uint64_t(size) : memoryWaitSequence++;
+    memoryWaitQueue.emplace(key, std::make_pair(pid, size));
+    ++memoryStallCount;
+    if (Process* process = processManager.getProcess(pid)) {
+        process->markArrived(std::chrono::steady_clock::now(), cpuTickCount.load());
+    }
+    tracer.record(EventTracer::SCHEDULER_RING, TraceEventType::MEMORY_ALLOC_FAIL, pid, -1, size);
+}
+
+void Scheduler::addToMemoryWaitQueue(int pid, int size) {
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
+    parkForMemory(pid, size);
+}
+
+uint64_t Scheduler::getMemoryStallCount() {
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
+    return memoryStallCount;
+}
+
+size_t Scheduler::getMemoryWaitQueueSize() {
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
+    return memoryWaitQueue.size();
+}
+
+// Admits parked processes only after memory was freed or moved, and only those that now fit
+void Scheduler::checkMemoryWaitQueue() {
+    auto memoryAllocator = getMemoryAllocator();
+    if (!memoryAllocator) return;
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
+
+    uint64_t epoch = memoryAllocator->getReleaseEpoch();
+    if (memoryWaitQueue.empty() || (epoch == lastReleaseEpoch && memoryAllocator.get() == lastEpochAllocator)) {
+        return;
+    }
+    lastReleaseEpoch = epoch;
+    lastEpochAllocator = memoryAllocator.get();
+
+    bool sizeOrdered = settings.current().memoryWaitOrder == MemoryWaitOrder::SIZE;
+    int largestFree = memoryAllocator->getLargestFreeBlock();
+    for (auto it = memoryWaitQueue.begin(); it != memoryWaitQueue.end() && largestFree > 0; ) {
+        int pid = it->second.first;
+        int size = it->second.second;
+        if (size > largestFree) {
+            // Sizes only grow from here, so nothing further can fit either
+            if (sizeOrdered) break;
+            ++it;
+            continue;
+        }
+        if (memoryAllocator->allocate(pid, size)) {
+            enqueueReady(pid);
+            it = memoryWaitQueue.erase(it);
+            largestFree = memoryAllocator->getLargestFreeBlock();
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Memory wait keys depend on the order; re-sorting keeps the queue consistent after a reload
+void Scheduler::rekeyMemoryWaitQueue(MemoryWaitOrder order) {
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
+    std::multimap<uint64_t, std::pair<int, int>> rekeyed;
+    for (const auto& [key, entry] : memoryWaitQueue) {
+        rekeyed.emplace(order == MemoryWaitOrder::SIZE ? uint64_t(entry.second) : memoryWaitSequence++, entry);
+    }
+    memoryWaitQueue.swap(rekeyed);
+}
+
 Scheduler::Scheduler(ProcessManager& pm)
-    : processManager(pm), running(false), algorithm(SchedulingAlgorithm::FCFS),
-      numCores(4), quantumCycles(1), delayPerExec(0) {
+    : processManager(pm), running(false), numCores(4) {
+    for (int core = 0; core < MAX_CORES; ++core) {
+        coreBusy.push_back(std::make_unique<std::atomic<bool>>(false));
+        coreActive.push_back(std::make_unique<std::atomic<bool>>(false));
+        coreProcess.push_back(std::make_unique<std::atomic<int>>(-1));
+        coreQuantumRemaining.push_back(std::make_unique<std::atomic<int>>(0));
+        coreBusyTicks.push_back(std::make_unique<std::atomic<uint64_t>>(0));
+        coreIdleTicks.push_back(std::make_unique<std::atomic<uint64_t>>(0));
+    }
+    coreTlbs.resize(MAX_CORES);
+    tracer.setTickSource(&cpuTickCount);
     initializeCores();
 }
 
+std::shared_ptr<FirstFitMemoryAllocator> Scheduler::getMemoryAllocator() const {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    return sharedAllocator;
+}
+
+void Scheduler::setMemoryAllocator(std::shared_ptr<FirstFitMemoryAllocator> allocator) {
+    std::lock_guard<std::mutex> lock(allocatorMutex);
+    sharedAllocator = std::move(allocator);
+}
+
 Scheduler::~Scheduler() {
     stop();
 }
 
 void Scheduler::start() {
     if (running) return;
-    
+    resetRunCounters();
+    resume();
+}
+
+// Per-run counters: snapshot numbering, the quantum position and the utilization time base
+void Scheduler::resetRunCounters() {
     quantumCycleCounter.store(0);
     lastSnapshotTick = 0;
+    lastSampleTick = cpuTickCount.load();
+    samplingStartedAt = std::chrono::steady_clock::now();
     currentQuantumTick = 0;
-    
+}
+
+void Scheduler::resume() {
+    if (running) return;
     running = true;
     
     // Start scheduler loop (for process scheduling)
@@ -57,11 +165,12 @@ void Scheduler::start() {
     // Start worker threads (for instruction execution and CPU ticks)
     workerThreads.clear();
     for (int i = 0; i < numCores; ++i) {
+        coreActive[i]->store(true);
         workerThreads.emplace_back(&Scheduler::workerLoop, this, i);
     }
 }
 
-void Scheduler::stop() {
+void Scheduler::pause() {
     if (!running) return;
     running = false;
     cv.notify_all();
@@ -72,6 +181,11 @@ void Scheduler::stop() {
         if (t.joinable()) t.join();
     }
     workerThreads.clear();
+}
+
+void Scheduler::stop() {
+    if (!running) return;
+    pause();
 
     for (int i = 0; i < numCores; ++i) {
         if (coreBusy[i]->load()) {
@@ -86,43 +200,267 @@ void Scheduler::stop() {
     }
 }
 
+void Scheduler::saveState(BinaryWriter& out) {
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
+    out.putVarint(cpuTickCount.load());
+    out.putVarint(static_cast<uint64_t>(numCores.load()));
+    for (int core = 0; core < numCores; ++core) {
+        out.putVarint(static_cast<uint64_t>(coreBusy[core]->load() ? coreProcess[core]->load() : 0));
+        out.putVarint(static_cast<uint64_t>(std::max(0, coreQuantumRemaining[core]->load())));
+        out.putVarint(coreBusyTicks[core]->load());
+        out.putVarint(coreIdleTicks[core]->load());
+    }
+    std::queue<int> ready = readyQueue;
+    out.putVarint(ready.size());
+    for (; !ready.empty(); ready.pop()) out.putVarint(static_cast<uint64_t>(ready.front()));
+    out.putVarint(waitingQueue.size());
+    for (const auto& [pid, ticks] : waitingQueue) {
+        out.putVarint(static_cast<uint64_t>(pid));
+        out.putVarint(static_cast<uint64_t>(std::max(0, ticks)));
+    }
+    out.putVarint(memoryWaitQueue.size());
+    for (const auto& [key, entry] : memoryWaitQueue) {
+        out.putVarint(key);
+        out.putVarint(static_cast<uint64_t>(entry.first));
+        out.putVarint(static_cast<uint64_t>(entry.second));
+    }
+    out.putVarint(memoryWaitSequence);
+    out.putVarint(completedPids.size());
+    for (int pid : completedPids) out.putVarint(static_cast<uint64_t>(pid));
+    out.putVarint(retiredCount.load());
+    out.putVarint(memoryStallCount);
+    out.putVarint(static_cast<uint64_t>(currentQuantumTick));
+    out.putVarint(static_cast<uint64_t>(quantumCycleCounter.load()));
+    out.putVarint(lastSampleTick);
+    out.putVarint(lastSampleBusyTicks);
+    out.putVarint(lastSampleTotalTicks);
+    out.putVarint(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - samplingStartedAt).count()));
+}
+
+bool Scheduler::restoreState(BinaryReader& in) {
+    if (running) return false;
+    uint64_t tick, cores;
+    if (!in.getVarint(tick) || !in.getVarint(cores) || cores != static_cast<uint64_t>(numCores.load())) return false;
+    initializeCores();
+    auto memoryAllocator = getMemoryAllocator();
+    const SchedulerSettings& active = settings.current();
+    for (int core = 0; core < numCores; ++core) {
+        int pid, quantum;
+        uint64_t busyTicks, idleTicks;
+        if (!in.getVarint(pid) || !in.getVarint(quantum) || !in.getVarint(busyTicks) || !in.getVarint(idleTicks)) return false;
+        coreBusyTicks[core]->store(busyTicks);
+        coreIdleTicks[core]->store(idleTicks);
+        Process* process = processManager.getProcess(pid);
+        if (!process) continue;
+        // Back on the same core with a cold TLB
+        coreTlbs[core]->contextSwitch(pid);
+        int base = memoryAllocator ? memoryAllocator->getBlockStart(pid) : 0;
+        process->mapMemory(base, std::max(uint32_t(16), active.config.memPerFrame), coreTlbs[core].get());
+        coreProcess[core]->store(pid);
+        coreQuantumRemaining[core]->store(quantum);
+        coreBusy[core]->store(true);
+    }
+
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
+    uint64_t count;
+    readyQueue = {};
+    if (!in.getVarint(count)) return false;
+    for (uint64_t i = 0; i < count; ++i) {
+        int pid;
+        if (!in.getVarint(pid)) return false;
+        readyQueue.push(pid);
+    }
+    waitingQueue.clear();
+    if (!in.getVarint(count)) return false;
+    for (uint64_t i = 0; i < count; ++i) {
+        int pid, ticks;
+        if (!in.getVarint(pid) || !in.getVarint(ticks)) return false;
+        waitingQueue.push_back({pid, ticks});
+    }
+    memoryWaitQueue.clear();
+    if (!in.getVarint(count)) return false;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t key;
+        int pid, size;
+        if (!in.getVarint(key) || !in.getVarint(pid) || !in.getVarint(size)) return false;
+        memoryWaitQueue.emplace(key, std::make_pair(pid, size));
+    }
+    completedPids.clear();
+    if (!in.getVarint(memoryWaitSequence) || !in.getVarint(count)) return false;
+    for (uint64_t i = 0; i < count; ++i) {
+        int pid;
+        if (!in.getVarint(pid)) return false;
+        completedPids.push_back(pid);
+    }
+    uint64_t retired;
+    int snapshots;
+    uint64_t samplingMicros;
+    if (!in.getVarint(retired) || !in.getVarint(memoryStallCount) || !in.getVarint(currentQuantumTick) ||
+        !in.getVarint(snapshots) || !in.getVarint(lastSampleTick) || !in.getVarint(lastSampleBusyTicks) ||
+        !in.getVarint(lastSampleTotalTicks) || !in.getVarint(samplingMicros)) {
+        return false;
+    }
+    retiredCount.store(retired);
+    quantumCycleCounter.store(snapshots);
+    samplingStartedAt = std::chrono::steady_clock::now() - std::chrono::microseconds(samplingMicros);
+    lastEpochAllocator = nullptr; // Re-check the memory wait queue on the first pass
+    cpuTickCount.store(tick);
+    return true;
+}
+
+SchedulerSettings SchedulerSettings::fromConfig(const SystemConfig& config) {
+    SchedulerSettings settings;
+    settings.config = config;
+    settings.algorithm = (config.scheduler == "rr") ? SchedulingAlgorithm::ROUND_ROBIN : SchedulingAlgorithm::FCFS;
+    settings.quantumCycles = static_cast<int>(std::max(uint32_t(1), config.quantumCycles));
+    settings.delayPerExec = static_cast<int>(config.delaysPerExec);
+    settings.tickMillis = static_cast<int>(config.tickMillis);
+    settings.compactionBlocksPerPass = static_cast<int>(std::max(uint32_t(1), config.compactionBlocksPerPass));
+    settings.memoryWaitOrder = (config.memoryWaitOrder == "size") ? MemoryWaitOrder::SIZE : MemoryWaitOrder::ARRIVAL;
+    if (config.retireLogs == "keep") {
+        settings.retireLogs = LogRetention::KEEP;
+    } else if (config.retireLogs == "drop") {
+        settings.retireLogs = LogRetention::DROP;
+    } else {
+        settings.retireLogs = LogRetention::SPILL;
+    }
+    settings.utilizationSampleTicks = config.utilizationSampleTicks;
+    return settings;
+}
+
 void Scheduler::updateConfig(const SystemConfig& newConfig) {
     bool wasRunning = running.load();
     if (wasRunning) stop();
-    
-    config = newConfig;
-    numCores = newConfig.numCPU;
-    quantumCycles = std::max(uint32_t(1), newConfig.quantumCycles);
-    delayPerExec = std::max(uint32_t(0), newConfig.delaysPerExec);
-    
-    if (newConfig.scheduler == "rr") {
-        algorithm = SchedulingAlgorithm::ROUND_ROBIN;
-    } else {
-        algorithm = SchedulingAlgorithm::FCFS;
-    }
-    
+
+    MemoryWaitOrder previousOrder = settings.current().memoryWaitOrder;
+    settings.publish(SchedulerSettings::fromConfig(newConfig));
+    if (settings.current().memoryWaitOrder != previousOrder) rekeyMemoryWaitQueue(settings.current().memoryWaitOrder);
+    numCores = std::clamp(newConfig.numCPU, 1, MAX_CORES);
     initializeCores();
+    tracer.configure(newConfig.traceEvents, numCores, newConfig.traceBufferEvents);
     if (wasRunning) start();
 }
 
+uint64_t Scheduler::reloadConfig(const SystemConfig& newConfig) {
+    MemoryWaitOrder previousOrder = settings.current().memoryWaitOrder;
+    uint64_t version = settings.publish(SchedulerSettings::fromConfig(newConfig));
+    if (settings.current().memoryWaitOrder != previousOrder) rekeyMemoryWaitQueue(settings.current().memoryWaitOrder);
+    tracer.setEnabled(newConfig.traceEvents);
+    resizeCores(std::clamp(newConfig.numCPU, 1, MAX_CORES));
+    return version;
+}
+
+void Scheduler::resetCore(int core) {
+    coreBusy[core]->store(false);
+    coreProcess[core]->store(-1);
+    coreQuantumRemaining[core]->store(0);
+    coreBusyTicks[core]->store(0);
+    coreIdleTicks[core]->store(0);
+    const SystemConfig& config = settings.current().config;
+    coreTlbs[core] = std::make_unique<Tlb>(config.tlbEntries, config.tlbWays, config.tlbAsid, config.tlbWalkCycles);
+}
+
 void Scheduler::initializeCores() {
-    coreBusy.clear();
-    coreProcess.clear();
-    coreQuantumRemaining.clear();
-    
-    for (int i = 0; i < numCores; ++i) {
-        coreBusy.push_back(std::make_unique<std::atomic<bool>>(false));
-        coreProcess.push_back(std::make_unique<std::atomic<int>>(-1));
-        coreQuantumRemaining.push_back(std::make_unique<std::atomic<int>>(0));
+    lastSampleBusyTicks = lastSampleTotalTicks = 0;
+    std::lock_guard<std::mutex> lock(tlbStatsMutex);
+    for (int core = 0; core < MAX_CORES; ++core) {
+        if (core < numCores) {
+            resetCore(core);
+        } else {
+            coreTlbs[core].reset();
+        }
+    }
+    tlbStatsCores = numCores;
+    removedCoreTlbStats = TlbStats();
+}
+
+// Only the console thread resizes, and it also owns workerThreads
+void Scheduler::resizeCores(int target) {
+    int current = numCores.load();
+    if (target > current) {
+        for (int core = current; core < target; ++core) {
+            resetCore(core);
+            coreActive[core]->store(true);
+        }
+        {
+            std::lock_guard<std::mutex> lock(tlbStatsMutex);
+            tlbStatsCores = target;
+        }
+        numCores.store(target);
+        if (running) {
+            for (int core = current; core < target; ++core) {
+                workerThreads.emplace_back(&Scheduler::workerLoop, this, core);
+            }
+        }
+        return;
+    }
+    if (target == current) return;
+
+    // Under the queue lock, so no schedule pass is halfway through a loop over the old count;
+    // nothing is dispatched past the new count from here, then the surplus workers finish their tick
+    {
+        std::lock_guard<ProfiledMutex> lock(queueMutex);
+        numCores.store(target);
+        for (int core = target; core < current; ++core) {
+            coreActive[core]->store(false);
+        }
+    }
+    if (running) {
+        for (size_t core = target; core < workerThreads.size(); ++core) {
+            if (workerThreads[core].joinable()) workerThreads[core].join();
+        }
+        workerThreads.resize(target);
+    }
+    {
+        // The removed cores' TLBs are final now; keep their counts in the total
+        std::lock_guard<std::mutex> lock(tlbStatsMutex);
+        for (int core = target; core < tlbStatsCores; ++core) {
+            removedCoreTlbStats += coreTlbs[core]->getStats();
+        }
+        tlbStatsCores = target;
+    }
+
+    // A retired core's process goes back to the ready queue with its memory, or to retirement
+    auto memoryAllocator = getMemoryAllocator();
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
+    for (int core = target; core < current; ++core) {
+        int pid = coreProcess[core]->load();
+        if (coreBusy[core]->load() && pid != -1) {
+            processManager.assignProcessToCore(pid, -1);
+            Process* process = processManager.getProcess(pid);
+            if (process && process->isComplete()) {
+                if (memoryAllocator) memoryAllocator->release(pid);
+                completedPids.push_back(pid);
+            } else if (process) {
+                tracer.record(EventTracer::SCHEDULER_RING, TraceEventType::PREEMPT, pid, core);
+                enqueueReady(pid);
+            }
+        }
+        coreBusy[core]->store(false);
+        coreProcess[core]->store(-1);
+        coreQuantumRemaining[core]->store(0);
     }
 }
 
 void Scheduler::addProcess(int pid) {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    readyQueue.push(pid);
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
+    enqueueReady(pid);
     cv.notify_one();
 }
 
+void Scheduler::addProcessBatch(const std::vector<int>& ready, const std::vector<std::pair<int, int>>& waitingForMemory) {
+    if (ready.empty() && waitingForMemory.empty()) return;
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
+    for (const auto& [pid, size] : waitingForMemory) {
+        parkForMemory(pid, size);
+    }
+    for (int pid : ready) {
+        enqueueReady(pid);
+    }
+    cv.notify_all();
+}
+
 bool Scheduler::isCoreBusy(int core) const {
     if (core < 0 || core >= numCores) return false;
     return coreBusy[core]->load();
@@ -133,7 +471,7 @@ int Scheduler::getNumCores() const {
 }
 
 SchedulingAlgorithm Scheduler::getAlgorithm() const {
-    return algorithm;
+    return settings.current().algorithm;
 }
 
 bool Scheduler::isRunning() const {
@@ -150,28 +488,45 @@ int Scheduler::getCoreQuantumRemaining(int core) const {
     return coreQuantumRemaining[core]->load();
 }
 
+TlbStats Scheduler::getCoreTlbStats(int core) const {
+    if (core < 0 || core >= numCores) return TlbStats();
+    return coreTlbs[core]->getStats();
+}
+
+TlbStats Scheduler::getTotalTlbStats() const {
+    std::lock_guard<std::mutex> lock(tlbStatsMutex);
+    TlbStats total = removedCoreTlbStats;
+    for (int i = 0; i < tlbStatsCores; ++i) {
+        total += coreTlbs[i]->getStats();
+    }
+    return total;
+}
+
 size_t Scheduler::getReadyQueueSize() {
-    std::lock_guard<std::mutex> lock(queueMutex);
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
     return readyQueue.size();
 }
 
 void Scheduler::scheduleFCFS() {
-    std::lock_guard<std::mutex> lock(queueMutex);
+    ScopedTimer timer(profile.scheduleFCFS);
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
     for (int core = 0; core < numCores; ++core) {
         if (!coreBusy[core]->load() && !readyQueue.empty()) {
             int pid = readyQueue.front();
             readyQueue.pop();
             
             Process* process = processManager.getProcess(pid);
-            if (process && !process->isComplete()) {
-                assignProcessToCore(pid, core);
+            if (process && !process->isComplete() && !assignProcessToCore(pid, core)) {
+                readyQueue.push(pid);
             }
         }
     }
 }
 
 void Scheduler::scheduleRR() {
-    std::lock_guard<std::mutex> lock(queueMutex);
+    ScopedTimer timer(profile.scheduleRR);
+    auto memoryAllocator = getMemoryAllocator();
+    std::lock_guard<ProfiledMutex> lock(queueMutex);
     
     for (int core = 0; core < numCores; ++core) {
         if (coreBusy[core]->load()) {
@@ -183,19 +538,23 @@ void Scheduler::scheduleRR() {
             if (!currentProcess || currentProcess->isComplete()) {
                 shouldPreempt = true;
                 if (currentProcess && currentProcess->isComplete()) {
-                    extern FirstFitMemoryAllocator* globalMemoryAllocator;
-                    if (globalMemoryAllocator && globalMemoryAllocator->isAllocated(currentPid)) {
-                        globalMemoryAllocator->release(currentPid);
+                    if (auto memoryAllocator = getMemoryAllocator()) {
+                        memoryAllocator->release(currentPid);
                     }
                 }
                 if (currentProcess) {
                     processManager.assignProcessToCore(currentPid, -1);
+                    if (currentProcess->isComplete()) {
+                        tracer.record(EventTracer::SCHEDULER_RING, TraceEventType::COMPLETE, currentPid, core);
+                        completedPids.push_back(currentPid);
+                    }
                 }
             }
             else if (coreQuantumRemaining[core]->load() <= 0) {
                 shouldPreempt = true;
+                tracer.record(EventTracer::SCHEDULER_RING, TraceEventType::PREEMPT, currentPid, core);
                 processManager.assignProcessToCore(currentPid, -1);
-                readyQueue.push(currentPid);
+                enqueueReady(currentPid);
             }
             
             if (shouldPreempt) {
@@ -209,8 +568,7 @@ void Scheduler::scheduleRR() {
     for (int core = 0; core < numCores; ++core) {
         if (!coreBusy[core]->load() && !readyQueue.empty()) {
             bool processAssigned = false;
-            std::queue<int> tempQueue;
-            
+
             while (!readyQueue.empty() && !processAssigned) {
                 int pid = readyQueue.front();
                 readyQueue.pop();
@@ -220,55 +578,140 @@ void Scheduler::scheduleRR() {
                     continue;
                 }
                 
-                extern FirstFitMemoryAllocator* globalMemoryAllocator;
-                if (globalMemoryAllocator && !globalMemoryAllocator->isAllocated(pid)) {
-                    if (!globalMemoryAllocator->allocate(pid)) {
-                        tempQueue.push(pid);
+                if (memoryAllocator && !memoryAllocator->isAllocated(pid)) {
+                    if (!memoryAllocator->allocate(pid, process->getMemorySize())) {
+                        // Parked until a release makes room, instead of being retried every pass
+                        parkForMemory(pid, process->getMemorySize());
                         continue;
                     }
                 }
                 
-                assignProcessToCore(pid, core);
-                coreQuantumRemaining[core]->store(quantumCycles);
+                if (!assignProcessToCore(pid, core)) {
+                    readyQueue.push(pid); // Keeps its memory; the next pass tries again
+                    break;
+                }
+                coreQuantumRemaining[core]->store(settings.current().quantumCycles);
                 processAssigned = true;
             }
-            
-            while (!tempQueue.empty()) {
-                readyQueue.push(tempQueue.front());
-                tempQueue.pop();
-            }
         }
     }
 }
 
-void Scheduler::assignProcessToCore(int pid, int core) {
+// Caller holds queueMutex
+bool Scheduler::assignProcessToCore(int pid, int core) {
     if (core < 0 || core >= numCores || coreBusy[core]->load()) {
-        return;
+        return false;
+    }
+    Process* process = processManager.getProcess(pid);
+    if (!process) return false;
+    // The core is idle, so its worker is not touching the TLB while we switch it
+    int base = 0;
+    if (auto memoryAllocator = getMemoryAllocator()) {
+        base = memoryAllocator->getBlockStart(pid);
+    }
+    coreTlbs[core]->contextSwitch(pid);
+    const SchedulerSettings& active = settings.current();
+    if (process->mapMemory(base, std::max(uint32_t(16), active.config.memPerFrame), coreTlbs[core].get())) {
+        // Compaction moved it, or the pid belonged to an earlier process; other cores may still cache it
+        for (int other = 0; other < numCores; ++other) {
+            coreTlbs[other]->invalidateAsid(pid);
+        }
+    }
+
+    bool firstDispatch = !process->hasBeenDispatched();
+    auto wait = process->markDispatched(std::chrono::steady_clock::now());
+    {
+        std::lock_guard<ProfiledMutex> lock(latencyMutex);
+        LatencyStats& stats = latency[static_cast<size_t>(active.algorithm)];
+        stats.readyWait.record(static_cast<uint64_t>(wait.count()));
+        if (firstDispatch) {
+            stats.response.record(static_cast<uint64_t>(process->getResponseTime().count()));
+        } else {
+            ++stats.contextSwitches;
+        }
     }
+    tracer.record(EventTracer::SCHEDULER_RING, TraceEventType::DISPATCH, pid, core);
     coreProcess[core]->store(pid);
     coreBusy[core]->store(true);
     processManager.assignProcessToCore(pid, core);
-    
-    int utilization = calculateCoreUtilization();
-    processManager.updateProcessUtilization(pid, utilization);
+    return true;
 }
 
-int Scheduler::calculateCoreUtilization() {
-    int busyCores = 0;
-    for (int i = 0; i < numCores; ++i) {
-        if (coreBusy[i]->load()) busyCores++;
+uint64_t Scheduler::getCoreBusyTicks(int core) const {
+    if (core < 0 || core >= numCores) return 0;
+    return coreBusyTicks[core]->load(std::memory_order_relaxed);
+}
+
+uint64_t Scheduler::getCoreIdleTicks(int core) const {
+    if (core < 0 || core >= numCores) return 0;
+    return coreIdleTicks[core]->load(std::memory_order_relaxed);
+}
+
+double Scheduler::getAverageUtilization() const {
+    uint64_t busy = 0, total = 0;
+    for (int core = 0; core < numCores; ++core) {
+        busy += getCoreBusyTicks(core);
+        total += getCoreBusyTicks(core) + getCoreIdleTicks(core);
+    }
+    return total == 0 ? 0.0 : 100.0 * busy / total;
+}
+
+// Emits one time-series row every utilizationSampleTicks; utilization covers just that interval
+void Scheduler::sampleUtilization() {
+    uint64_t sampleTicks = settings.current().utilizationSampleTicks;
+    if (sampleTicks == 0 || !utilizationSampleCallback) return;
+    uint64_t tick = cpuTickCount.load();
+    if (tick - lastSampleTick < sampleTicks) return;
+    lastSampleTick = tick;
+
+    UtilizationSample sample;
+    sample.tick = tick;
+    sample.elapsedMillis = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - samplingStartedAt).count());
+    sample.totalCores = numCores;
+    uint64_t busy = 0, total = 0;
+    for (int core = 0; core < numCores; ++core) {
+        if (coreBusy[core]->load()) ++sample.busyCores;
+        busy += getCoreBusyTicks(core);
+        total += getCoreBusyTicks(core) + getCoreIdleTicks(core);
+    }
+    uint64_t intervalTotal = total - lastSampleTotalTicks;
+    sample.intervalUtilization = intervalTotal == 0 ? 0.0 : 100.0 * (busy - lastSampleBusyTicks) / intervalTotal;
+    lastSampleBusyTicks = busy;
+    lastSampleTotalTicks = total;
+    {
+        std::lock_guard<ProfiledMutex> lock(queueMutex);
+        sample.readyQueue = readyQueue.size();
+        sample.sleeping = waitingQueue.size();
+        sample.waitingForMemory = memoryWaitQueue.size();
+    }
+    if (auto memoryAllocator = getMemoryAllocator()) {
+        sample.residentProcesses = memoryAllocator->getNumProcessesInMemory();
+        sample.externalFragmentation = memoryAllocator->getExternalFragmentation();
+    }
+    utilizationSampleCallback(sample);
+}
+
+// A zero tick length still yields so the cores and the scheduler share the host CPUs
+void Scheduler::pace(int millis) {
+    if (millis > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(millis));
+    } else {
+        std::this_thread::yield();
     }
-    return (numCores == 0) ? 0 : (busyCores * 100 / numCores);
 }
 
 void Scheduler::schedulerLoop() {
     while (running) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        // Two passes per tick, as with the original 100/50 ms pacing
+        pace(settings.current().tickMillis / 2);
         if (!running) break;
+        const SchedulerSettings& active = settings.current();
         
         checkWaitingQueue();
+        checkMemoryWaitQueue();
         
-        switch (algorithm) {
+        switch (active.algorithm) {
             case SchedulingAlgorithm::FCFS:
                 scheduleFCFS();
                 break;
@@ -277,30 +720,135 @@ void Scheduler::schedulerLoop() {
                 break;
         }
         
-        if (algorithm == SchedulingAlgorithm::ROUND_ROBIN) {
+        compactMemory();
+        retireCompletedProcesses();
+        sampleUtilization();
+
+        if (active.algorithm == SchedulingAlgorithm::ROUND_ROBIN) {
             checkAndTakeSnapshot();
         }
     }
 }
 
 void Scheduler::checkAndTakeSnapshot() {
+    ScopedTimer timer(profile.checkAndTakeSnapshot);
     currentQuantumTick++;
     
     // Take snapshot every quantum cycles
-    if (currentQuantumTick >= quantumCycles) {
+    if (currentQuantumTick >= settings.current().quantumCycles) {
         currentQuantumTick = 0;
         if (memorySnapshotCallback) {
             int snapshotNum = quantumCycleCounter.fetch_add(1) + 1;
+            tracer.record(EventTracer::SCHEDULER_RING, TraceEventType::SNAPSHOT, -1, -1, snapshotNum);
             memorySnapshotCallback(snapshotNum);
         }
     }
 }
 
+// Swaps finished processes for their summaries, and frees the ones swapped out on an earlier
+// pass once every core has begun a new tick, since a worker only holds a Process within one
+void Scheduler::retireCompletedProcesses() {
+    if (processManager.hasSealedRetired()) {
+        bool passed = true;
+        for (int core = 0; core < MAX_CORES && passed; ++core) {
+            passed = !coreActive[core]->load() || coreIterations(core) != graceMarks[core];
+        }
+        if (passed) processManager.freeSealed();
+    }
+
+    std::vector<int> finished;
+    {
+        std::lock_guard<ProfiledMutex> lock(queueMutex);
+        finished.swap(completedPids);
+    }
+    const SchedulerSettings& active = settings.current();
+    for (int pid : finished) {
+        // Already retired if it was reported twice
+        const Process* process = processManager.getProcess(pid);
+        if (!process || !process->isComplete()) continue;
+        {
+            std::lock_guard<ProfiledMutex> lock(latencyMutex);
+            latency[static_cast<size_t>(active.algorithm)].turnaround.record(
+                static_cast<uint64_t>(process->getTurnaroundTime().count()));
+        }
+        processManager.retireProcess(pid, active.retireLogs);
+        retiredCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (processManager.sealRetired()) {
+        graceMarks.resize(MAX_CORES);
+        for (int core = 0; core < MAX_CORES; ++core) {
+            graceMarks[core] = coreIterations(core);
+        }
+    }
+}
+
+uint64_t Scheduler::coreIterations(int core) const {
+    return coreBusyTicks[core]->load() + coreIdleTicks[core]->load();
+}
+
+void Scheduler::printProfileReport(std::ostream& out) const {
+    out << "lock                      acquires  contended    wait(us)  mean(us)   max(us)    hold(us)  mean(us)   max(us)\n";
+    printLockProfile(out, queueMutex);
+    printLockProfile(out, latencyMutex);
+    out << "\nsection                      calls     total(us)  mean(us)   max(us)\n";
+    for (const ProfiledSection* section : {&profile.scheduleFCFS, &profile.scheduleRR, &profile.checkWaitingQueue,
+                                           &profile.checkAndTakeSnapshot, &profile.workerExecute}) {
+        printSectionProfile(out, *section);
+    }
+}
+
+LatencyStats Scheduler::getLatencyStats() const {
+    std::lock_guard<ProfiledMutex> lock(latencyMutex);
+    return latency[static_cast<size_t>(settings.current().algorithm)];
+}
+
+void Scheduler::printLatencyReport(std::ostream& out) const {
+    auto printRow = [&](const char* name, const LatencyHistogram& histogram) {
+        auto ms = [](uint64_t micros) { return micros / 1000.0; };
+        out << std::left << std::setw(14) << name << std::right
+            << std::setw(8) << histogram.getCount()
+            << std::fixed << std::setprecision(2)
+            << std::setw(12) << ms(histogram.getPercentile(50))
+            << std::setw(12) << ms(histogram.getPercentile(95))
+            << std::setw(12) << ms(histogram.getPercentile(99))
+            << std::setw(12) << ms(histogram.getMax()) << "\n";
+    };
+    std::lock_guard<ProfiledMutex> lock(latencyMutex);
+    for (size_t index = 0; index < latency.size(); ++index) {
+        const LatencyStats& stats = latency[index];
+        if (stats.readyWait.getCount() == 0) continue;
+        out << (static_cast<SchedulingAlgorithm>(index) == SchedulingAlgorithm::FCFS ? "FCFS" : "Round Robin")
+            << " (" << stats.contextSwitches << " context switches)\n";
+        out << "metric           count     p50(ms)     p95(ms)     p99(ms)     max(ms)\n";
+        printRow("ready wait", stats.readyWait);
+        printRow("response", stats.response);
+        printRow("turnaround", stats.turnaround);
+        out << "\n";
+    }
+}
+
+// Runs a bounded slice of compaction so a fragmented memory never stalls a pass for long
+void Scheduler::compactMemory() {
+    auto memoryAllocator = getMemoryAllocator();
+    if (!memoryAllocator) return;
+    // Only this thread puts processes on cores, so a pid seen off-core stays off-core
+    memoryAllocator->compactStep(settings.current().compactionBlocksPerPass, [this](int pid) {
+        for (int core = 0; core < numCores; ++core) {
+            if (coreProcess[core]->load() == pid) return false;
+        }
+        return true;
+    });
+}
+
 void Scheduler::workerLoop(int core) {
-    while (running) {
-        cpuTickCount++;
+    while (running && coreActive[core]->load()) {
+        const SchedulerSettings& active = settings.current();
+        uint64_t tick = ++cpuTickCount;
+        bool busy = coreBusy[core]->load();
+        (busy ? coreBusyTicks : coreIdleTicks)[core]->fetch_add(1, std::memory_order_relaxed);
 
-        if (coreBusy[core]->load()) {
+        if (busy) {
             int pid = coreProcess[core]->load();
             Process* process = processManager.getProcess(pid);
 
@@ -308,40 +856,51 @@ void Scheduler::workerLoop(int core) {
                 if (!process->isComplete()) {
                     // Handle sleep
                     if (process->getSleepTicks() > 0) {
-                        {
-                            std::lock_guard<std::mutex> lock(queueMutex);
+                        std::lock_guard<ProfiledMutex> lock(queueMutex);
+                        // A preempt may have requeued it and put another process on this core
+                        if (coreProcess[core]->load() == pid) {
+                            tracer.record(core, TraceEventType::SLEEP, pid, core, process->getSleepTicks());
                             waitingQueue.push_back({pid, process->getSleepTicks()});
+                            processManager.assignProcessToCore(pid, -1);
+                            coreBusy[core]->store(false);
+                            coreProcess[core]->store(-1);
+                            coreQuantumRemaining[core]->store(0);
                         }
-                        processManager.assignProcessToCore(pid, -1);
-                        coreBusy[core]->store(false);
-                        coreProcess[core]->store(-1);
-                        coreQuantumRemaining[core]->store(0);
                         continue;
                     }
-                    std::string result = process->executeNextInstruction();
-                    if (algorithm == SchedulingAlgorithm::ROUND_ROBIN) {
+                    {
+                        ScopedTimer timer(profile.workerExecute);
+                        process->executeNextInstruction();
+                        process->addCpuTick(tick, numCores.load());
+                    }
+                    if (active.algorithm == SchedulingAlgorithm::ROUND_ROBIN) {
                         int remaining = coreQuantumRemaining[core]->load();
                         if (remaining > 0) {
                             coreQuantumRemaining[core]->store(remaining - 1);
                         }
                     }
 
-                    if (delayPerExec > 0) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(delayPerExec));
+                    if (active.delayPerExec > 0) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(active.delayPerExec));
                     }
                 } else {
-                    processManager.assignProcessToCore(pid, -1);
-                    extern FirstFitMemoryAllocator* globalMemoryAllocator;
-                    if (globalMemoryAllocator && globalMemoryAllocator->isAllocated(pid)) {
-                        globalMemoryAllocator->release(pid);
+                    // Likewise scheduleRR may have taken it off this core already
+                    std::lock_guard<ProfiledMutex> lock(queueMutex);
+                    if (coreProcess[core]->load() == pid) {
+                        tracer.record(core, TraceEventType::COMPLETE, pid, core);
+                        processManager.assignProcessToCore(pid, -1);
+                        if (auto memoryAllocator = getMemoryAllocator()) {
+                            memoryAllocator->release(pid);
+                        }
+                        coreBusy[core]->store(false);
+                        coreProcess[core]->store(-1);
+                        coreQuantumRemaining[core]->store(0);
+                        completedPids.push_back(pid);
                     }
-                    coreBusy[core]->store(false);
-                    coreProcess[core]->store(-1);
-                    coreQuantumRemaining[core]->store(0);
                 }
             }
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        pace(active.tickMillis);
     }
 }
\ No newline at end of file
@@ -7,71 +7,188 @@
 #include <atomic>
 #include <vector>
 #include <memory>
-
-extern std::atomic<uint64_t> cpuTickCount; // Global CPU tick counter
-
+#include <map>
+#include <array>
+#include <ostream>
 #include <fstream>
 #include <chrono>
 #include "ProcessManager.h"
 #include "Config.h"
 #include "FirstFitMemoryAllocator.h"
+#include "Tlb.h"
+#include "EventTracer.h"
+#include "LatencyHistogram.h"
+#include "UtilizationRecorder.h"
+#include "Profiler.h"
+#include "Versioned.h"
 
 enum class SchedulingAlgorithm {
     FCFS,
     ROUND_ROBIN
 };
 
+// Microsecond histograms for one scheduling algorithm
+struct LatencyStats {
+    LatencyHistogram readyWait;  // Each stint in the ready queue
+    LatencyHistogram response;   // Arrival to first dispatch
+    LatencyHistogram turnaround; // Arrival to completion
+    uint64_t contextSwitches = 0;
+};
+
+enum class MemoryWaitOrder {
+    ARRIVAL,
+    SIZE
+};
+
+// Everything the scheduler and worker threads read while running, published as one version
+struct SchedulerSettings {
+    SystemConfig config;
+    SchedulingAlgorithm algorithm = SchedulingAlgorithm::FCFS;
+    int quantumCycles = 1;
+    int delayPerExec = 0;
+    int tickMillis = 100;
+    int compactionBlocksPerPass = 4;
+    MemoryWaitOrder memoryWaitOrder = MemoryWaitOrder::ARRIVAL;
+    LogRetention retireLogs = LogRetention::SPILL;
+    uint64_t utilizationSampleTicks = 0; // 0 turns sampling off
+
+    static SchedulerSettings fromConfig(const SystemConfig& config);
+};
+
 class Scheduler {
+public:
+    // Per-core state is allocated up front for this many cores, so cores can come and go live
+    static constexpr int MAX_CORES = 256;
 private:
     ProcessManager& processManager;
+    std::atomic<uint64_t> cpuTickCount{0};
+    // Reference counted so initialize can swap it while threads hold the old one
+    std::shared_ptr<FirstFitMemoryAllocator> sharedAllocator;
+    mutable std::mutex allocatorMutex;
     std::queue<int> readyQueue;
-    std::mutex queueMutex;
+    mutable ProfiledMutex queueMutex{"queueMutex"};
     std::condition_variable cv;
     std::thread schedulerThread;
     std::vector<std::thread> workerThreads;
     std::vector<std::unique_ptr<std::atomic<bool>>> coreBusy;
+    std::vector<std::unique_ptr<std::atomic<bool>>> coreActive; // Cleared to retire a core's worker
     std::vector<std::unique_ptr<std::atomic<int>>> coreProcess;
     std::vector<std::unique_ptr<std::atomic<int>>> coreQuantumRemaining;
+    std::vector<std::unique_ptr<std::atomic<uint64_t>>> coreBusyTicks;
+    std::vector<std::unique_ptr<std::atomic<uint64_t>>> coreIdleTicks;
+    std::vector<std::unique_ptr<Tlb>> coreTlbs;
+    mutable std::mutex tlbStatsMutex;
+    int tlbStatsCores = 0;          // Cores whose TLBs count toward the total; lags numCores while shrinking
+    TlbStats removedCoreTlbStats;   // Cores removed by reload, folded in once their workers stopped
+    EventTracer tracer;
+    std::array<LatencyStats, 2> latency; // Indexed by SchedulingAlgorithm
+    mutable ProfiledMutex latencyMutex{"latencyMutex"};
+    struct {
+        ProfiledSection scheduleFCFS{"scheduleFCFS"};
+        ProfiledSection scheduleRR{"scheduleRR"};
+        ProfiledSection checkWaitingQueue{"checkWaitingQueue"};
+        ProfiledSection checkAndTakeSnapshot{"checkAndTakeSnapshot"};
+        ProfiledSection workerExecute{"worker execute"};
+    } profile;
     std::atomic<bool> running;
-    SchedulingAlgorithm algorithm;
-    SystemConfig config;
-    int numCores;
+    Versioned<SchedulerSettings> settings;
+    std::atomic<int> numCores;
     std::vector<std::pair<int, int>> waitingQueue;
+    std::vector<int> completedPids; // Finished and off their core, waiting to be retired
+    std::vector<uint64_t> graceMarks; // Per-core iterations when the sealed retirements were unlinked
+    // Processes blocked on memory, keyed by arrival sequence or size -> (pid, size)
+    std::multimap<uint64_t, std::pair<int, int>> memoryWaitQueue;
+    uint64_t memoryWaitSequence = 0;
+    uint64_t lastReleaseEpoch = 0;
+    const FirstFitMemoryAllocator* lastEpochAllocator = nullptr;
     std::function<void(uint64_t)> memorySnapshotCallback;
+    std::function<void(const UtilizationSample&)> utilizationSampleCallback;
+    uint64_t lastSampleTick = 0;
+    uint64_t lastSampleBusyTicks = 0;
+    uint64_t lastSampleTotalTicks = 0;
+    std::chrono::steady_clock::time_point samplingStartedAt;
     std::atomic<int> quantumCycleCounter{0};
     uint64_t lastSnapshotTick = 0;
     int currentQuantumTick = 0;
     bool finalSnapshotTaken = false;
 
-    int quantumCycles;
-    int delayPerExec;
+    std::atomic<uint64_t> retiredCount{0};
+    uint64_t memoryStallCount = 0; // Guarded by queueMutex
 
     void scheduleFCFS();
     void scheduleRR();
-    void assignProcessToCore(int pid, int core);
-    int calculateCoreUtilization();
+    // False if the core is gone or busy, or the process no longer exists; the caller keeps the pid
+    bool assignProcessToCore(int pid, int core);
     void schedulerLoop();
     void workerLoop(int core);
     void checkAndTakeSnapshot();
+    void compactMemory();
+    void parkForMemory(int pid, int size);
+    void retireCompletedProcesses();
+    uint64_t coreIterations(int core) const;
+    void enqueueReady(int pid);
+    void sampleUtilization();
+    void pace(int millis);
+    void resizeCores(int target);
+    void resetRunCounters();
+    void resetCore(int core);
+    void rekeyMemoryWaitQueue(MemoryWaitOrder order);
 
 public:
     Scheduler(ProcessManager& pm);
     ~Scheduler();
     void updateConfig(const SystemConfig& newConfig);
+    // Applies a new config without stopping: settings swap atomically and cores are added or
+    // retired one at a time, with a retired core's process going back to the ready queue
+    uint64_t reloadConfig(const SystemConfig& newConfig);
+    uint64_t getConfigVersion() const { return settings.version(); }
+    std::shared_ptr<FirstFitMemoryAllocator> getMemoryAllocator() const;
+    void setMemoryAllocator(std::shared_ptr<FirstFitMemoryAllocator> allocator);
 
     void initializeCores();
+    // A fresh run: snapshot numbering, quantum position and the utilization clock start over
     void start();
     void stop();
+    // Stops the threads but leaves processes on their cores; resume() carries on from there
+    void pause();
+    // Restarts the threads after pause() or restoreState() without resetting any counters
+    void resume();
+    // Checkpoint form of the queues, cores and tick counters. Only while stopped or paused, and
+    // restore expects the process table and allocator to be restored already.
+    void saveState(BinaryWriter& out);
+    bool restoreState(BinaryReader& in);
     void addProcess(int pid);
+    // One lock for a whole arrival batch: ready pids plus (pid, size) pairs that memory could not admit
+    void addProcessBatch(const std::vector<int>& ready, const std::vector<std::pair<int, int>>& waitingForMemory);
     bool isCoreBusy(int core) const;
     int getNumCores() const;
     SchedulingAlgorithm getAlgorithm() const;
     bool isRunning() const;
     int getCoreProcess(int core) const;
     int getCoreQuantumRemaining(int core) const;
+    TlbStats getCoreTlbStats(int core) const;
+    TlbStats getTotalTlbStats() const;
+    // Stays valid after later reloads
+    const SystemConfig& getConfig() const { return settings.current().config; }
+    EventTracer& getTracer() { return tracer; }
+    void printLatencyReport(std::ostream& out) const;
+    void printProfileReport(std::ostream& out) const;
     size_t getReadyQueueSize();
     uint64_t getCurrentTick() const { return cpuTickCount.load(); }
     void checkWaitingQueue();
     void addToWaitingQueue(int pid, int sleepTicks);
+    void checkMemoryWaitQueue();
+    void addToMemoryWaitQueue(int pid, int size);
+    size_t getMemoryWaitQueueSize();
     void setMemorySnapshotCallback(std::function<void(uint64_t)> cb) { memorySnapshotCallback = std::move(cb); }
+    void setUtilizationSampleCallback(std::function<void(const UtilizationSample&)> cb) { utilizationSampleCallback = std::move(cb); }
+    uint64_t getCoreBusyTicks(int core) const;
+    uint64_t getCoreIdleTicks(int core) const;
+    // Busy share of every core tick since the cores were created
+    double getAverageUtilization() const;
+    // Stats for the active algorithm
+    LatencyStats getLatencyStats() const;
+    uint64_t getRetiredCount() const { return retiredCount.load(std::memory_order_relaxed); }
+    // Times a process was parked because memory could not admit it
+    uint64_t getMemoryStallCount();
 };
\ No newline at end of file
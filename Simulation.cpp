@@ -0,0 +1,65 @@
+#include "Simulation.h"
+#include <chrono>
+#include <string>
+#include <thread>
+
+Simulation::Simulation(const SystemConfig& config, uint32_t seed)
+    : config(config), generator(seed) {
+    memoryAllocator = std::make_shared<FirstFitMemoryAllocator>(config.maxOverallMem, config.minMemPerProc,
+        FirstFitMemoryAllocator::policyFromString(config.memAllocPolicy));
+    memoryAllocator->setCompactionThreshold(config.compactionThreshold);
+    scheduler.setMemoryAllocator(memoryAllocator);
+    scheduler.updateConfig(config);
+}
+
+Simulation::~Simulation() {
+    scheduler.stop();
+}
+
+SimulationResult Simulation::run(uint64_t processes, uint64_t inFlight, double maxSeconds) {
+    using Clock = std::chrono::steady_clock;
+    SimulationResult result;
+    uint64_t startTick = scheduler.getCurrentTick();
+    uint64_t startRetired = scheduler.getRetiredCount();
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(maxSeconds));
+    scheduler.start();
+
+    while (scheduler.getRetiredCount() - startRetired < processes) {
+        if (Clock::now() >= deadline) {
+            result.timedOut = true;
+            break;
+        }
+        if (result.created < processes && result.created - (scheduler.getRetiredCount() - startRetired) < inFlight) {
+            int pid = processManager.createProcess("p" + std::to_string(processManager.getProcessCount() + 1));
+            Process* proc = processManager.getProcess(pid);
+            if (!proc) {
+                processes = result.created; // Table full; let the ones already created finish
+                continue;
+            }
+            ++result.created;
+            proc->setMemorySize(generator.drawMemorySize(config));
+            generator.generate(proc, config);
+            if (!memoryAllocator->allocate(pid, proc->getMemorySize())) {
+                scheduler.addToMemoryWaitQueue(pid, proc->getMemorySize());
+            } else {
+                scheduler.addProcess(pid);
+            }
+            continue;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    scheduler.stop();
+
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.ticks = scheduler.getCurrentTick() - startTick;
+    result.completed = scheduler.getRetiredCount() - startRetired;
+    processManager.forEachProcess([&](const Process& process) { result.executed += process.getCpuTicks(); },
+                                  [&](const RetiredProcess& retired) { result.executed += retired.cpuTicks; });
+    LatencyStats latency = scheduler.getLatencyStats();
+    result.dispatchP50 = latency.readyWait.getPercentile(50);
+    result.dispatchP99 = latency.readyWait.getPercentile(99);
+    result.dispatchMax = latency.readyWait.getMax();
+    result.memoryStalls = scheduler.getMemoryStallCount();
+    return result;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "Config.h"
+#include "FirstFitMemoryAllocator.h"
+#include "ProcessManager.h"
+#include "ProgramGenerator.h"
+#include "Scheduler.h"
+
+struct SimulationResult {
+    uint64_t created = 0;
+    uint64_t completed = 0;
+    uint64_t executed = 0;
+    uint64_t ticks = 0;
+    double seconds = 0.0;
+    uint64_t dispatchP50 = 0; // Ready-queue wait before dispatch, microseconds
+    uint64_t dispatchP99 = 0;
+    uint64_t dispatchMax = 0;
+    uint64_t memoryStalls = 0;
+    bool timedOut = false;
+};
+
+// A headless simulator: process table, scheduler (with its own tick counter and cores), memory
+// allocator and program generator. Instances share no state, so any number can run at once in
+// one process. Output writers and the console are not part of it.
+class Simulation {
+public:
+    explicit Simulation(const SystemConfig& config, uint32_t seed = 42);
+    ~Simulation();
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // Generates processes as a steady stream with at most inFlight live at once, until all of
+    // them retire or maxSeconds of wall time pass
+    SimulationResult run(uint64_t processes, uint64_t inFlight, double maxSeconds);
+
+    ProcessManager& getProcessManager() { return processManager; }
+    Scheduler& getScheduler() { return scheduler; }
+    FirstFitMemoryAllocator& getMemoryAllocator() { return *memoryAllocator; }
+
+private:
+    SystemConfig config;
+    ProgramGenerator generator;
+    ProcessManager processManager;
+    Scheduler scheduler{processManager};
+    std::shared_ptr<FirstFitMemoryAllocator> memoryAllocator;
+};
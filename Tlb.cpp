@@ -0,0 +1,84 @@
+#include "Tlb.h"
+#include <algorithm>
+
+Tlb::Tlb(int numEntries, int ways, bool asidTagged, int walkCost)
+    : ways(std::max(1, ways)), asidTagged(asidTagged), walkCost(walkCost) {
+    numEntries = std::max(this->ways, numEntries);
+    numSets = numEntries / this->ways;
+    entries.resize(numSets * this->ways);
+}
+
+uint32_t Tlb::translate(int asid, uint32_t vpn, const std::vector<uint32_t>& pageTable) {
+    if (hasPending.load(std::memory_order_acquire)) {
+        applyPendingInvalidations();
+    }
+    Entry* set = &entries[(vpn % numSets) * ways];
+    ++useCounter;
+
+    Entry* victim = set;
+    for (int w = 0; w < ways; ++w) {
+        Entry& e = set[w];
+        if (e.valid && e.vpn == vpn && e.asid == asid) {
+            e.lastUse = useCounter;
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return e.frame;
+        }
+        if (!e.valid || (victim->valid && e.lastUse < victim->lastUse)) {
+            victim = &e;
+        }
+    }
+
+    // Miss: walk the page table and refill the least recently used way
+    misses.fetch_add(1, std::memory_order_relaxed);
+    walkCycles.fetch_add(walkCost, std::memory_order_relaxed);
+    uint32_t frame = vpn < pageTable.size() ? pageTable[vpn] : 0;
+    victim->valid = true;
+    victim->asid = asid;
+    victim->vpn = vpn;
+    victim->frame = frame;
+    victim->lastUse = useCounter;
+    return frame;
+}
+
+void Tlb::contextSwitch(int asid) {
+    if (!asidTagged && asid != currentAsid) {
+        flush();
+    }
+    currentAsid = asid;
+}
+
+void Tlb::flush() {
+    for (auto& e : entries) {
+        e.valid = false;
+    }
+    flushes.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Tlb::invalidateAsid(int asid) {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pendingAsids.push_back(asid);
+    hasPending.store(true, std::memory_order_release);
+}
+
+void Tlb::applyPendingInvalidations() {
+    std::vector<int> asids;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        asids.swap(pendingAsids);
+        hasPending.store(false, std::memory_order_relaxed);
+    }
+    for (auto& e : entries) {
+        if (e.valid && std::find(asids.begin(), asids.end(), e.asid) != asids.end()) {
+            e.valid = false;
+        }
+    }
+}
+
+TlbStats Tlb::getStats() const {
+    TlbStats stats;
+    stats.hits = hits.load(std::memory_order_relaxed);
+    stats.misses = misses.load(std::memory_order_relaxed);
+    stats.walkCycles = walkCycles.load(std::memory_order_relaxed);
+    stats.flushes = flushes.load(std::memory_order_relaxed);
+    return stats;
+}
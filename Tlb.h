@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+struct TlbStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t walkCycles = 0;
+    uint64_t flushes = 0;
+
+    uint64_t accesses() const { return hits + misses; }
+    double hitRate() const { return accesses() == 0 ? 0.0 : 100.0 * hits / accesses(); }
+    double missRate() const { return accesses() == 0 ? 0.0 : 100.0 * misses / accesses(); }
+    TlbStats& operator+=(const TlbStats& other) {
+        hits += other.hits;
+        misses += other.misses;
+        walkCycles += other.walkCycles;
+        flushes += other.flushes;
+        return *this;
+    }
+};
+
+// Set-associative, LRU translation cache for one core. Entries are tagged with the pid as ASID;
+// without ASID tagging the whole cache is flushed whenever the core switches process.
+class Tlb {
+public:
+    Tlb(int numEntries, int ways, bool asidTagged, int walkCost);
+    uint32_t translate(int asid, uint32_t vpn, const std::vector<uint32_t>& pageTable);
+    void contextSwitch(int asid);
+    void flush();
+    // Drops one ASID's entries; safe from any thread, applied before the owning core's next lookup
+    void invalidateAsid(int asid);
+    TlbStats getStats() const;
+    int getNumEntries() const { return numSets * ways; }
+    int getWays() const { return ways; }
+    bool isAsidTagged() const { return asidTagged; }
+private:
+    struct Entry {
+        bool valid = false;
+        int asid = -1;
+        uint32_t vpn = 0;
+        uint32_t frame = 0;
+        uint64_t lastUse = 0;
+    };
+
+    int numSets;
+    int ways;
+    bool asidTagged;
+    int walkCost; // Simulated cycles charged per page-table walk
+    int currentAsid = -1;
+    uint64_t useCounter = 0;
+    std::vector<Entry> entries;
+    std::mutex pendingMutex;
+    std::vector<int> pendingAsids;
+    std::atomic<bool> hasPending{false};
+
+    void applyPendingInvalidations();
+
+    // Written by the owning core's worker, read by vmstat and memory stamps
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> walkCycles{0};
+    std::atomic<uint64_t> flushes{0};
+};
@@ -0,0 +1,61 @@
+#include "UtilizationRecorder.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+UtilizationCsvWriter::~UtilizationCsvWriter() {
+    stop();
+}
+
+bool UtilizationCsvWriter::start(const std::string& path, uint32_t interval) {
+    stop();
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    file.open(path, std::ios::trunc);
+    if (!file.is_open()) return false;
+    file << "tick,elapsed_ms,busy_cores,total_cores,utilization_pct,ready_queue,sleeping,"
+            "waiting_for_memory,resident_processes,external_fragmentation\n";
+    flushMillis = std::max(uint32_t(1), interval);
+    running = true;
+    writerThread = std::thread(&UtilizationCsvWriter::writerLoop, this);
+    return true;
+}
+
+// Writes out whatever is still buffered before joining
+void UtilizationCsvWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        if (!running) return;
+        running = false;
+    }
+    bufferCv.notify_one();
+    if (writerThread.joinable()) writerThread.join();
+    file.close();
+}
+
+void UtilizationCsvWriter::submit(const UtilizationSample& sample) {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    if (!running) return;
+    frontBuffer.push_back(sample);
+}
+
+void UtilizationCsvWriter::writerLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(bufferMutex);
+            bufferCv.wait_for(lock, std::chrono::milliseconds(flushMillis), [this] { return !running; });
+            if (frontBuffer.empty() && !running) break;
+            std::swap(frontBuffer, backBuffer);
+        }
+        if (backBuffer.empty()) continue;
+        for (const auto& sample : backBuffer) {
+            file << sample.tick << ',' << sample.elapsedMillis << ','
+                 << sample.busyCores << ',' << sample.totalCores << ','
+                 << std::fixed << std::setprecision(2) << sample.intervalUtilization << ','
+                 << sample.readyQueue << ',' << sample.sleeping << ',' << sample.waitingForMemory << ','
+                 << sample.residentProcesses << ',' << sample.externalFragmentation << '\n';
+        }
+        rowsWritten += backBuffer.size();
+        backBuffer.clear();
+        file.flush();
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+// One row of the utilization time series, taken by the scheduler every sample interval
+struct UtilizationSample {
+    uint64_t tick = 0;
+    uint64_t elapsedMillis = 0;
+    int busyCores = 0;
+    int totalCores = 0;
+    double intervalUtilization = 0.0; // Busy share of all core ticks since the previous sample
+    size_t readyQueue = 0;
+    size_t sleeping = 0;
+    size_t waitingForMemory = 0;
+    int residentProcesses = 0;
+    int externalFragmentation = 0;
+};
+
+// Streams samples to a CSV file. submit() only appends to an in-memory batch; a background
+// thread swaps the batch out and formats/writes it every flush interval.
+class UtilizationCsvWriter {
+public:
+    UtilizationCsvWriter() = default;
+    ~UtilizationCsvWriter();
+    UtilizationCsvWriter(const UtilizationCsvWriter&) = delete;
+    UtilizationCsvWriter& operator=(const UtilizationCsvWriter&) = delete;
+
+    bool start(const std::string& path, uint32_t flushMillis);
+    void stop();
+    void submit(const UtilizationSample& sample);
+    uint64_t getRowsWritten() const { return rowsWritten.load(); }
+private:
+    std::ofstream file; // Only touched by the writer thread once started
+    uint32_t flushMillis = 500;
+    std::vector<UtilizationSample> frontBuffer;
+    std::vector<UtilizationSample> backBuffer;
+    std::mutex bufferMutex;
+    std::condition_variable bufferCv;
+    std::thread writerThread;
+    bool running = false;
+    std::atomic<uint64_t> rowsWritten{0};
+
+    void writerLoop();
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Publishes immutable versions of a value. Readers take the current one with a single atomic
+// load and never block; every version is kept until the owner is destroyed, so a reference from
+// current() stays valid across later publishes. Meant for rarely changing settings.
+template <typename T>
+class Versioned {
+public:
+    Versioned() { publish(T{}); }
+    Versioned(const Versioned&) = delete;
+    Versioned& operator=(const Versioned&) = delete;
+
+    const T& current() const { return head.load(std::memory_order_acquire)->value; }
+    uint64_t version() const { return head.load(std::memory_order_acquire)->number; }
+
+    uint64_t publish(T value) {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        history.push_back(std::make_unique<Entry>(Entry{std::move(value), history.size()}));
+        head.store(history.back().get(), std::memory_order_release);
+        return history.back()->number;
+    }
+
+private:
+    struct Entry {
+        T value;
+        uint64_t number;
+    };
+
+    std::atomic<const Entry*> head{nullptr};
+    std::mutex publishMutex;
+    std::vector<std::unique_ptr<Entry>> history;
+};
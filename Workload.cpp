@@ -0,0 +1,85 @@
+#include "Workload.h"
+#include "Process.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace {
+    constexpr char WORKLOAD_MAGIC[4] = {'C', 'S', 'W', 'L'};
+}
+
+bool WorkloadRecorder::open(const std::string& path, uint32_t seed) {
+    std::lock_guard<std::mutex> lock(recordMutex);
+    if (file.is_open()) file.close();
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    out.reset();
+    lastArrival = 0;
+    recorded = 0;
+    uint32_t version = VERSION;
+    file.write(WORKLOAD_MAGIC, 4);
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(&seed), sizeof(seed));
+    return static_cast<bool>(file);
+}
+
+void WorkloadRecorder::close() {
+    std::lock_guard<std::mutex> lock(recordMutex);
+    if (file.is_open()) file.close();
+}
+
+void WorkloadRecorder::record(uint64_t arrivalTick, const Process& process) {
+    std::lock_guard<std::mutex> lock(recordMutex);
+    if (!file.is_open()) return;
+    out.clearBuffer();
+    // Screen sessions can record out of order with the generator; clamp rather than go negative
+    uint64_t arrival = std::max(arrivalTick, lastArrival);
+    out.putVarint(arrival - lastArrival);
+    lastArrival = arrival;
+    out.putString(process.getProcessName());
+    out.putVarint(static_cast<uint64_t>(process.getMemorySize()));
+    const auto& program = process.getInstructions();
+    out.putVarint(program.size());
+    for (const auto& instruction : program) {
+        writeInstruction(out, *instruction);
+    }
+    file.write(out.data().data(), static_cast<std::streamsize>(out.size()));
+    ++recorded;
+}
+
+bool WorkloadReader::open(const std::string& path) {
+    loaded = false;
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    in = BinaryReader(contents.data(), contents.data() + contents.size());
+
+    char magic[4];
+    uint32_t version;
+    if (!in.getRaw(magic, 4) || std::memcmp(magic, WORKLOAD_MAGIC, 4) != 0 ||
+        !in.getRaw(&version, sizeof(version)) || version != WorkloadRecorder::VERSION ||
+        !in.getRaw(&seed, sizeof(seed))) {
+        contents.clear();
+        return false;
+    }
+    lastArrival = 0;
+    loaded = true;
+    return true;
+}
+
+bool WorkloadReader::next(WorkloadProcess& process) {
+    uint64_t delta, memorySize, count;
+    if (!loaded || !in.getVarint(delta)) return false;
+    if (!in.getString(process.name) || !in.getVarint(memorySize) || !in.getVarint(count)) return false;
+    lastArrival += delta;
+    process.arrivalTick = lastArrival;
+    process.memorySize = static_cast<int>(memorySize);
+    process.program.clear();
+    process.program.reserve(std::min<uint64_t>(count, in.remaining()));
+    for (uint64_t i = 0; i < count; ++i) {
+        auto instruction = readInstruction(in);
+        if (!instruction) return false;
+        process.program.push_back(std::move(instruction));
+    }
+    return true;
+}
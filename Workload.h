@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <mutex>
+#include <cstdint>
+#include "ProcessInstruction.h"
+#include "BinaryCodec.h"
+
+class Process;
+
+// One arrival in a captured workload
+struct WorkloadProcess {
+    uint64_t arrivalTick = 0; // Ticks since process generation started
+    std::string name;
+    int memorySize = 0;
+    std::vector<std::unique_ptr<IProcessInstruction>> program;
+};
+
+/*
+Workload file layout:
+  header  {magic "CSWL", u32 version, u32 seed}
+  records {varint arrival delta, name, varint memory size, varint instruction count, instructions}
+  instruction {u8 type, operands}; FOR stores its repeat count and body recursively
+Integers are varints and strings are interned (see BinaryCodec.h), so repeated messages and
+variables are tiny.
+*/
+class WorkloadRecorder {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    bool open(const std::string& path, uint32_t seed);
+    void record(uint64_t arrivalTick, const Process& process);
+    void close();
+    bool isOpen() const { return file.is_open(); }
+    uint64_t getRecorded() const { return recorded; }
+private:
+    std::ofstream file;
+    BinaryWriter out;
+    uint64_t lastArrival = 0;
+    uint64_t recorded = 0;
+    std::mutex recordMutex; // Generator thread and screen -s both record
+};
+
+class WorkloadReader {
+public:
+    bool open(const std::string& path);
+    // False at the end of the file or on a corrupt record
+    bool next(WorkloadProcess& process);
+    uint32_t getSeed() const { return seed; }
+    bool isOpen() const { return loaded; }
+private:
+    std::vector<char> contents; // The whole file, read at open
+    BinaryReader in;
+    bool loaded = false;
+    uint64_t lastArrival = 0;
+    uint32_t seed = 0;
+};